@@ -0,0 +1,99 @@
+#include "ChunkedResult.h"
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+namespace react = facebook::react;
+
+// Rows converted between two looks at the clock
+static constexpr size_t clock_stride = 32;
+
+ChunkedResult::ChunkedResult(
+    jsi::Runtime &rt, std::shared_ptr<react::CallInvoker> js_call_invoker,
+    BridgeResult status, std::shared_ptr<ResultBuffer> results,
+    std::shared_ptr<std::vector<SmartHostObject>> metadata,
+    ExecuteOptions options, std::shared_ptr<jsi::Value> resolve,
+    std::shared_ptr<jsi::Value> reject)
+    : rt(rt), js_call_invoker(std::move(js_call_invoker)),
+      status(std::move(status)), results(std::move(results)),
+      metadata(std::move(metadata)), options(std::move(options)),
+      resolve(std::move(resolve)), reject(std::move(reject)){};
+
+void ChunkedResult::start() {
+  results->big_ints = options.big_ints;
+
+  if (options.on_chunk == nullptr) {
+    rows.emplace(rt, results->row_count());
+  }
+
+  deliver_chunk();
+}
+
+void ChunkedResult::deliver_chunk() {
+  try {
+    auto deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::duration<double, std::milli>(options.chunk_budget_ms);
+    size_t row_count = results->row_count();
+    std::vector<jsi::Value> chunk;
+
+    // At least one stride per chunk so a tiny budget still makes progress
+    while (next_row < row_count) {
+      size_t stride_end = std::min(next_row + clock_stride, row_count);
+
+      for (; next_row < stride_end; next_row++) {
+        auto row = create_row(rt, results, next_row, options.row_mode);
+        if (rows.has_value()) {
+          rows->setValueAtIndex(rt, next_row, std::move(row));
+        } else {
+          chunk.push_back(std::move(row));
+        }
+      }
+
+      if (std::chrono::steady_clock::now() >= deadline) {
+        break;
+      }
+    }
+
+    if (!chunk.empty()) {
+      auto chunk_array = jsi::Array(rt, chunk.size());
+      for (size_t i = 0; i < chunk.size(); i++) {
+        chunk_array.setValueAtIndex(rt, i, std::move(chunk[i]));
+      }
+      options.on_chunk->asObject(rt).asFunction(rt).call(
+          rt, std::move(chunk_array));
+    }
+
+    if (next_row < row_count) {
+      auto self = shared_from_this();
+      js_call_invoker->invokeAsync([self] { self->deliver_chunk(); });
+      return;
+    }
+
+    finish();
+  } catch (std::exception &exc) {
+    auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+    auto error = errorCtr.callAsConstructor(
+        rt, jsi::String::createFromUtf8(rt, exc.what()));
+    reject->asObject(rt).asFunction(rt).call(rt, error);
+  }
+}
+
+void ChunkedResult::finish() {
+  // The rows were already handed over, only the rest of the result is left
+  auto res = createResult(rt, status, std::make_shared<ResultBuffer>(),
+                          metadata, options)
+                 .asObject(rt);
+
+  if (rows.has_value()) {
+    auto rows_obj = jsi::Object(rt);
+    rows_obj.setProperty(rt, "length",
+                         jsi::Value(static_cast<double>(results->row_count())));
+    rows_obj.setProperty(rt, "_array", std::move(*rows));
+    res.setProperty(rt, "rows", std::move(rows_obj));
+  }
+
+  resolve->asObject(rt).asFunction(rt).call(rt, std::move(res));
+}
+
+} // namespace opsqlite
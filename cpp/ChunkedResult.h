@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ResultBuffer.h"
+#include "SmartHostObject.h"
+#include "types.h"
+#include "utils.h"
+#include <ReactCommon/CallInvoker.h>
+#include <chrono>
+#include <jsi/jsi.h>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+namespace react = facebook::react;
+
+/// Hands a large async result to JS a chunk at a time. Each chunk converts
+/// rows until its time budget runs out, then the next one is queued behind
+/// whatever else is waiting on the JS thread, so a big result does not block
+/// rendering. The promise resolves once every row has been converted, or,
+/// with onChunk, every chunk is passed to the callback as it is ready and the
+/// promise resolves with a result without rows
+class ChunkedResult : public std::enable_shared_from_this<ChunkedResult> {
+public:
+  ChunkedResult(jsi::Runtime &rt,
+                std::shared_ptr<react::CallInvoker> js_call_invoker,
+                BridgeResult status, std::shared_ptr<ResultBuffer> results,
+                std::shared_ptr<std::vector<SmartHostObject>> metadata,
+                ExecuteOptions options, std::shared_ptr<jsi::Value> resolve,
+                std::shared_ptr<jsi::Value> reject);
+
+  /// Converts the first chunk, must be called on the JS thread
+  void start();
+
+private:
+  void deliver_chunk();
+  void finish();
+
+  jsi::Runtime &rt;
+  std::shared_ptr<react::CallInvoker> js_call_invoker;
+  BridgeResult status;
+  std::shared_ptr<ResultBuffer> results;
+  std::shared_ptr<std::vector<SmartHostObject>> metadata;
+  ExecuteOptions options;
+  std::shared_ptr<jsi::Value> resolve;
+  std::shared_ptr<jsi::Value> reject;
+
+  // Rows converted so far when they are collected instead of streamed
+  std::optional<jsi::Array> rows;
+  size_t next_row = 0;
+};
+
+} // namespace opsqlite
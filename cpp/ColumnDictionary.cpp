@@ -0,0 +1,77 @@
+#include "ColumnDictionary.h"
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+
+ColumnDictionary::ColumnDictionary(std::vector<std::string> names)
+    : names(std::move(names)) {
+  index.reserve(this->names.size());
+  first.reserve(this->names.size());
+
+  // With duplicated names the first column wins, as it did with the linear
+  // search
+  for (size_t i = 0; i < this->names.size(); i++) {
+    first.push_back(index.emplace(this->names[i], i).first->second);
+  }
+}
+
+size_t ColumnDictionary::find(std::string const &name) const {
+  auto it = index.find(name);
+  return it == index.end() ? npos : it->second;
+}
+
+size_t ColumnDictionary::find(jsi::Runtime &rt,
+                              const jsi::PropNameID &prop_name) {
+  if (props.size() != names.size()) {
+    create_prop_names(rt);
+  }
+
+  size_t count = props.size();
+
+  for (size_t i = 0; i < count; i++) {
+    size_t column = (next + i) % count;
+
+    if (jsi::PropNameID::compare(rt, props[column], prop_name)) {
+      next = column + 1;
+      return first[column];
+    }
+  }
+
+  return npos;
+}
+
+std::vector<jsi::PropNameID> ColumnDictionary::prop_names(jsi::Runtime &rt) {
+  if (props.size() != names.size()) {
+    create_prop_names(rt);
+  }
+
+  std::vector<jsi::PropNameID> keys;
+  keys.reserve(props.size());
+
+  for (auto const &prop : props) {
+    keys.push_back(jsi::PropNameID(rt, prop));
+  }
+
+  return keys;
+}
+
+jsi::PropNameID const &ColumnDictionary::prop_name(jsi::Runtime &rt,
+                                                   size_t column) {
+  if (props.size() != names.size()) {
+    create_prop_names(rt);
+  }
+
+  return props[column];
+}
+
+void ColumnDictionary::create_prop_names(jsi::Runtime &rt) {
+  props.clear();
+  props.reserve(names.size());
+
+  for (auto const &name : names) {
+    props.push_back(jsi::PropNameID::forUtf8(rt, name));
+  }
+}
+
+} // namespace opsqlite
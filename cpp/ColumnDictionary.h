@@ -0,0 +1,47 @@
+#pragma once
+
+#include <jsi/jsi.h>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+
+/// Column names of a result set, shared by all of its rows. Names are hashed
+/// once, and their PropNameIDs are created the first time JS reads a row, so
+/// looking up a property neither allocates nor converts it to a string. The
+/// PropNameIDs belong to the runtime, only touch them from the JS thread
+class ColumnDictionary {
+public:
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  explicit ColumnDictionary(std::vector<std::string> names);
+
+  size_t size() const { return names.size(); }
+  std::string const &name(size_t column) const { return names[column]; }
+  // Columns named like an earlier one, which wins when looking them up
+  bool is_shadowed(size_t column) const { return first[column] != column; }
+
+  size_t find(std::string const &name) const;
+  size_t find(jsi::Runtime &rt, const jsi::PropNameID &prop_name);
+
+  std::vector<jsi::PropNameID> prop_names(jsi::Runtime &rt);
+  jsi::PropNameID const &prop_name(jsi::Runtime &rt, size_t column);
+
+private:
+  void create_prop_names(jsi::Runtime &rt);
+
+  std::vector<std::string> names;
+  std::unordered_map<std::string, size_t> index;
+  // First column with the same name as each column
+  std::vector<size_t> first;
+  std::vector<jsi::PropNameID> props;
+  // Column after the last one found, rows are mostly read column by column
+  // so it is usually the next match
+  size_t next = 0;
+};
+
+} // namespace opsqlite
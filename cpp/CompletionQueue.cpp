@@ -0,0 +1,71 @@
+#include "CompletionQueue.h"
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+namespace react = facebook::react;
+
+CompletionQueue::CompletionQueue(
+    jsi::Runtime &rt, std::shared_ptr<react::CallInvoker> js_call_invoker)
+    : rt(rt), js_call_invoker(std::move(js_call_invoker)){};
+
+void CompletionQueue::push(std::function<void()> completion) {
+  bool schedule;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(std::move(completion));
+    schedule = !scheduled;
+    scheduled = true;
+  }
+
+  if (schedule) {
+    auto self = shared_from_this();
+    js_call_invoker->invokeAsync([self] { self->drain(); });
+  }
+}
+
+void CompletionQueue::drain() {
+  std::vector<std::function<void()>> batch;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    batch.swap(pending);
+    scheduled = false;
+  }
+
+  // A throwing completion does not keep the others from settling
+  std::exception_ptr first_error;
+  for (auto &completion : batch) {
+    try {
+      completion();
+    } catch (...) {
+      if (!first_error) {
+        first_error = std::current_exception();
+      }
+    }
+  }
+
+  if (first_error) {
+    std::rethrow_exception(first_error);
+  }
+}
+
+jsi::Function const &CompletionQueue::promise_constructor() {
+  if (!promise_ctor.has_value()) {
+    promise_ctor.emplace(rt.global().getPropertyAsFunction(rt, "Promise"));
+  }
+
+  return *promise_ctor;
+}
+
+jsi::Value CompletionQueue::create_error(std::string const &message) {
+  if (!error_ctor.has_value()) {
+    error_ctor.emplace(rt.global().getPropertyAsFunction(rt, "Error"));
+  }
+
+  return error_ctor->callAsConstructor(
+      rt, jsi::String::createFromUtf8(rt, message));
+}
+
+} // namespace opsqlite
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ReactCommon/CallInvoker.h>
+#include <functional>
+#include <jsi/jsi.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+namespace react = facebook::react;
+
+/// Settles the promises of async queries on the JS thread. Workers push
+/// completions from any thread, the first one pushed after a drain schedules
+/// a single invokeAsync that runs every completion queued by the time it
+/// runs, so a burst of finished queries costs one JS task instead of one per
+/// query. The Promise and Error constructors are looked up once and kept
+class CompletionQueue : public std::enable_shared_from_this<CompletionQueue> {
+public:
+  CompletionQueue(jsi::Runtime &rt,
+                  std::shared_ptr<react::CallInvoker> js_call_invoker);
+
+  void push(std::function<void()> completion);
+
+  /// JS thread only
+  jsi::Function const &promise_constructor();
+  jsi::Value create_error(std::string const &message);
+
+private:
+  void drain();
+
+  jsi::Runtime &rt;
+  std::shared_ptr<react::CallInvoker> js_call_invoker;
+
+  std::mutex mutex;
+  std::vector<std::function<void()>> pending;
+  bool scheduled = false;
+
+  std::optional<jsi::Function> promise_ctor;
+  std::optional<jsi::Function> error_ctor;
+};
+
+} // namespace opsqlite
@@ -0,0 +1,257 @@
+#include "CursorHostObject.h"
+#include "DumbHostObject.h"
+#include "bridge.h"
+#include "macros.h"
+#include "utils.h"
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+namespace react = facebook::react;
+
+CursorHostObject::CursorHostObject(
+    jsi::Runtime &rt, std::string db_name, sqlite3_stmt *stmt,
+    std::shared_ptr<react::CallInvoker> js_call_invoker,
+    std::shared_ptr<ThreadPool> thread_pool,
+    std::shared_ptr<TransactionSlot> transaction_slot)
+    : rt(rt), db_name(std::move(db_name)), stmt(stmt),
+      js_call_invoker(std::move(js_call_invoker)),
+      thread_pool(std::move(thread_pool)),
+      transaction_slot(std::move(transaction_slot)){};
+
+std::vector<jsi::PropNameID>
+CursorHostObject::getPropertyNames(jsi::Runtime &rt) {
+  std::vector<jsi::PropNameID> keys;
+
+  return keys;
+}
+
+jsi::Value CursorHostObject::get(jsi::Runtime &rt,
+                                 const jsi::PropNameID &propNameID) {
+  auto name = propNameID.utf8(rt);
+
+  if (name == "next") {
+    return HOSTFN("next", 1) {
+      if (count < 1 || !args[0].isNumber() || args[0].asNumber() < 1) {
+        throw std::runtime_error(
+            "[op-sqlite][cursor] number of rows must be a positive number");
+      }
+
+      size_t rows = static_cast<size_t>(args[0].asNumber());
+
+      auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+      auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+        auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+        auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+        read(rows, resolve, reject);
+        return {};
+      }));
+
+      return promise;
+    });
+  }
+
+  if (name == "close") {
+    return HOSTFN("close", 0) {
+      close();
+      return {};
+    });
+  }
+
+  return {};
+}
+
+void CursorHostObject::read(size_t rows, std::shared_ptr<jsi::Value> resolve,
+                            std::shared_ptr<jsi::Value> reject) {
+  bool busy;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    busy = pending.has_value();
+    if (!busy) {
+      chunk_size = rows;
+      pending = PendingRead{rows, resolve, reject};
+    }
+  }
+
+  // Reads are not queued, callers need to await the previous one
+  if (busy) {
+    auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+    auto error = errorCtr.callAsConstructor(
+        rt, jsi::String::createFromAscii(
+                rt, "[op-sqlite][cursor] next called while another read is "
+                    "pending"));
+    reject->asObject(rt).asFunction(rt).call(rt, error);
+    return;
+  }
+
+  serve_pending();
+}
+
+/// Resolves the pending read if enough rows are buffered, otherwise asks the
+/// worker for the missing rows. Always runs on the JS thread
+void CursorHostObject::serve_pending() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  if (!pending.has_value()) {
+    return;
+  }
+
+  size_t available = buffered_rows();
+
+  if (available < pending->rows && !done && !closed) {
+    if (!fetching) {
+      fetch(pending->rows - available);
+    }
+    return;
+  }
+
+  PendingRead read = std::move(*pending);
+  pending.reset();
+
+  if (!error.empty() && available == 0) {
+    std::string message = error;
+    lock.unlock();
+
+    auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+    auto js_error = errorCtr.callAsConstructor(
+        rt, jsi::String::createFromUtf8(rt, message));
+    read.reject->asObject(rt).asFunction(rt).call(rt, js_error);
+    return;
+  }
+
+  jsi::Array rows = take_rows(read.rows);
+
+  // Read ahead the next chunk while JS processes this one
+  if (!done && !closed && !fetching && buffered_rows() < chunk_size) {
+    fetch(chunk_size - buffered_rows());
+  }
+
+  lock.unlock();
+
+  read.resolve->asObject(rt).asFunction(rt).call(rt, std::move(rows));
+}
+
+/// Must be called with the mutex held
+void CursorHostObject::fetch(size_t rows) {
+  fetching = true;
+
+  auto self = shared_from_this();
+  thread_pool->queueWork(transaction_slot->strand(db_name),
+                         [self, rows] { self->step(rows); });
+}
+
+void CursorHostObject::step(size_t rows) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (closed) {
+      fetching = false;
+      finalize_statement();
+      return;
+    }
+  }
+
+  auto chunk = std::make_shared<ResultBuffer>();
+  bool finished = false;
+  BridgeResult result;
+
+  try {
+    result =
+        opsqlite_step_statement(db_name, stmt, rows, chunk.get(), &finished);
+  } catch (std::exception &exc) {
+    result = {.type = SQLiteError, .message = exc.what()};
+    finished = true;
+  }
+
+  bool notify;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    fetching = false;
+
+    if (result.type == SQLiteError) {
+      error = result.message;
+    }
+
+    // Finalizing as soon as possible ends the read transaction
+    if (finished || closed) {
+      done = true;
+      finalize_statement();
+    }
+
+    if (!closed && chunk->row_count() > 0) {
+      chunks.push_back(std::move(chunk));
+    }
+
+    notify = pending.has_value();
+  }
+
+  if (notify) {
+    auto self = shared_from_this();
+    js_call_invoker->invokeAsync([self] { self->serve_pending(); });
+  }
+}
+
+void CursorHostObject::close() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  closed = true;
+  chunks.clear();
+  front_row = 0;
+
+  // A fetch in flight owns the statement, it will finalize it when done
+  if (!fetching) {
+    finalize_statement();
+  }
+
+  lock.unlock();
+
+  serve_pending();
+}
+
+/// Must be called with the mutex held
+size_t CursorHostObject::buffered_rows() {
+  size_t rows = 0;
+  for (auto const &chunk : chunks) {
+    rows += chunk->row_count();
+  }
+  return rows - front_row;
+}
+
+/// Must be called with the mutex held. Rows are views into the chunks, so
+/// handing them to JS does not copy any data
+jsi::Array CursorHostObject::take_rows(size_t max_rows) {
+  size_t row_count = std::min(max_rows, buffered_rows());
+  auto array = jsi::Array(rt, row_count);
+
+  for (size_t i = 0; i < row_count; i++) {
+    auto chunk = chunks.front();
+    array.setValueAtIndex(
+        rt, i,
+        jsi::Object::createFromHostObject(
+            rt, std::make_shared<DumbHostObject>(chunk, front_row)));
+
+    front_row++;
+    if (front_row == chunk->row_count()) {
+      chunks.pop_front();
+      front_row = 0;
+    }
+  }
+
+  return array;
+}
+
+void CursorHostObject::finalize_statement() {
+  if (stmt != nullptr) {
+    opsqlite_finalize_statement(db_name, stmt);
+    stmt = nullptr;
+  }
+}
+
+CursorHostObject::~CursorHostObject() { finalize_statement(); }
+
+} // namespace opsqlite
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ResultBuffer.h"
+#include "ThreadPool.h"
+#include "TransactionHostObject.h"
+#include <ReactCommon/CallInvoker.h>
+#include <deque>
+#include <jsi/jsi.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sqlite3.h>
+#include <string>
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+namespace react = facebook::react;
+
+/// Wraps a live statement and hands its rows to JS in chunks. Stepping
+/// happens on the thread pool and the next chunk is read ahead while JS
+/// consumes the current one, but never more than one chunk is buffered so
+/// memory stays flat no matter how big the result set is
+class JSI_EXPORT CursorHostObject
+    : public jsi::HostObject,
+      public std::enable_shared_from_this<CursorHostObject> {
+public:
+  CursorHostObject(jsi::Runtime &rt, std::string db_name, sqlite3_stmt *stmt,
+                   std::shared_ptr<react::CallInvoker> js_call_invoker,
+                   std::shared_ptr<ThreadPool> thread_pool,
+                   std::shared_ptr<TransactionSlot> transaction_slot);
+  virtual ~CursorHostObject();
+
+  std::vector<jsi::PropNameID> getPropertyNames(jsi::Runtime &rt);
+
+  jsi::Value get(jsi::Runtime &rt, const jsi::PropNameID &propNameID);
+
+private:
+  struct PendingRead {
+    size_t rows;
+    std::shared_ptr<jsi::Value> resolve;
+    std::shared_ptr<jsi::Value> reject;
+  };
+
+  void read(size_t rows, std::shared_ptr<jsi::Value> resolve,
+            std::shared_ptr<jsi::Value> reject);
+  void serve_pending();
+  void fetch(size_t rows);
+  void step(size_t rows);
+  void close();
+  size_t buffered_rows();
+  jsi::Array take_rows(size_t max_rows);
+  void finalize_statement();
+
+  jsi::Runtime &rt;
+  std::string db_name;
+  // Only touched by the worker that is currently fetching, or under the mutex
+  // when no fetch is in flight
+  sqlite3_stmt *stmt;
+  std::shared_ptr<react::CallInvoker> js_call_invoker;
+  std::shared_ptr<ThreadPool> thread_pool;
+  // Reads sent while a transaction is open run inside it
+  std::shared_ptr<TransactionSlot> transaction_slot;
+
+  std::mutex mutex;
+  // Chunks read from the statement but not yet handed to JS, front_row is the
+  // first row of the front chunk that has not been consumed
+  std::deque<std::shared_ptr<ResultBuffer>> chunks;
+  size_t front_row = 0;
+  // Size of the last read, used to prefetch the next chunk
+  size_t chunk_size = 0;
+  std::optional<PendingRead> pending;
+  std::string error;
+  bool fetching = false;
+  bool done = false;
+  bool closed = false;
+};
+
+} // namespace opsqlite
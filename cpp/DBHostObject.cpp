@@ -1,5 +1,13 @@
 #include "DBHostObject.h"
+#include "ChunkedResult.h"
+#include "CompletionQueue.h"
 #include "PreparedStatementHostObject.h"
+#include "SingleFlight.h"
+#ifndef OP_SQLITE_USE_LIBSQL
+#include "CursorHostObject.h"
+#include "GroupCommit.h"
+#include "TransactionHostObject.h"
+#endif
 #if OP_SQLITE_USE_LIBSQL
 #include "libsql/bridge.h"
 #else
@@ -16,6 +24,40 @@ namespace jsi = facebook::jsi;
 namespace react = facebook::react;
 
 #ifndef OP_SQLITE_USE_LIBSQL
+/// Reads the optional `{transactionMode, chunkSize}` argument of the batch
+/// functions
+BatchOptions to_batch_options(jsi::Runtime &rt, const jsi::Value &value) {
+  BatchOptions options;
+
+  if (!value.isObject()) {
+    return options;
+  }
+
+  auto object = value.asObject(rt);
+
+  auto mode = object.getProperty(rt, "transactionMode");
+  if (mode.isString()) {
+    auto mode_str = mode.asString(rt).utf8(rt);
+    if (mode_str == "deferred") {
+      options.begin = BeginCommand;
+    } else if (mode_str == "immediate") {
+      options.begin = BeginImmediateCommand;
+    } else if (mode_str == "exclusive") {
+      options.begin = BeginExclusiveCommand;
+    } else {
+      throw std::runtime_error("[op-sqlite][executeBatch] transactionMode must "
+                               "be deferred, immediate or exclusive");
+    }
+  }
+
+  auto chunk_size = object.getProperty(rt, "chunkSize");
+  if (chunk_size.isNumber() && chunk_size.asNumber() > 0) {
+    options.chunk_size = static_cast<size_t>(chunk_size.asNumber());
+  }
+
+  return options;
+}
+
 void DBHostObject::auto_register_update_hook() {
   if (update_hook_callback == nullptr && reactive_queries.empty() &&
       is_update_hook_registered) {
@@ -32,20 +74,18 @@ void DBHostObject::auto_register_update_hook() {
                      std::string operation, int rowId) {
     if (update_hook_callback != nullptr) {
       std::vector<JSVariant> params;
-      std::vector<DumbHostObject> results;
+      auto results = std::make_shared<ResultBuffer>();
       std::shared_ptr<std::vector<SmartHostObject>> metadata =
           std::make_shared<std::vector<SmartHostObject>>();
 
       if (operation != "DELETE") {
         std::string query = "SELECT * FROM " + table_name +
                             " where rowid = " + std::to_string(rowId) + ";";
-        opsqlite_execute(name, query, &params, &results, metadata);
+        opsqlite_execute(name, query, &params, results.get(), metadata);
       }
 
       jsCallInvoker->invokeAsync(
-          [this,
-           results = std::make_shared<std::vector<DumbHostObject>>(results),
-           callback = update_hook_callback, table_name,
+          [this, results, callback = update_hook_callback, table_name,
            operation = std::move(operation), &rowId] {
             auto res = jsi::Object(rt);
             res.setProperty(rt, "table",
@@ -53,11 +93,11 @@ void DBHostObject::auto_register_update_hook() {
             res.setProperty(rt, "operation",
                             jsi::String::createFromUtf8(rt, operation));
             res.setProperty(rt, "rowId", jsi::Value(rowId));
-            if (!results->empty()) {
-              res.setProperty(
-                  rt, "row",
-                  jsi::Object::createFromHostObject(
-                      rt, std::make_shared<DumbHostObject>(results->at(0))));
+            if (results->row_count() > 0) {
+              res.setProperty(rt, "row",
+                              jsi::Object::createFromHostObject(
+                                  rt, std::make_shared<DumbHostObject>(
+                                          results, 0)));
             }
 
             callback->asObject(rt).asFunction(rt).call(rt, res);
@@ -97,12 +137,12 @@ void DBHostObject::auto_register_update_hook() {
         continue;
       }
 
-      std::vector<DumbHostObject> results;
+      auto results = std::make_shared<ResultBuffer>();
       std::shared_ptr<std::vector<SmartHostObject>> metadata =
           std::make_shared<std::vector<SmartHostObject>>();
 
-      auto status = opsqlite_execute_prepared_statement(db_name, query->stmt,
-                                                        &results, metadata);
+      auto status = opsqlite_execute_prepared_statement(
+          db_name, query->stmt, results.get(), metadata);
 
       if (status.type == SQLiteError) {
         jsCallInvoker->invokeAsync(
@@ -114,11 +154,9 @@ void DBHostObject::auto_register_update_hook() {
             });
       } else {
         jsCallInvoker->invokeAsync(
-            [this,
-             results = std::make_shared<std::vector<DumbHostObject>>(results),
-             callback = query->callback, metadata, status = std::move(status)] {
-              auto jsiResult =
-                  createResult(rt, status, results.get(), metadata);
+            [this, results, callback = query->callback, metadata,
+             status = std::move(status)] {
+              auto jsiResult = createResult(rt, status, results, metadata);
               callback->asObject(rt).asFunction(rt).call(rt, jsiResult);
             });
       }
@@ -130,6 +168,70 @@ void DBHostObject::auto_register_update_hook() {
 }
 #endif
 
+/// Any work queued on the database strand after a write that is being
+/// coalesced has to run after it, so the batch stops collecting writes. Unless
+/// the work is a shared read, the reads in flight stop taking callers too
+void DBHostObject::seal_group_commit(bool shared_read) {
+  if (!shared_read) {
+    seal_single_flight();
+  }
+#ifndef OP_SQLITE_USE_LIBSQL
+  if (group_commit != nullptr) {
+    group_commit->seal();
+  }
+#endif
+}
+
+/// Reads sent after something that may write must not be answered by a read
+/// that started before it
+void DBHostObject::seal_single_flight() {
+  if (single_flight != nullptr) {
+    single_flight->seal();
+  }
+}
+
+/// A read skips the queue of the database only when nothing is waiting in it,
+/// work sent before it may open a transaction whose changes it has to see
+bool DBHostObject::use_reader(std::string const &query) {
+#ifdef OP_SQLITE_USE_LIBSQL
+  return false;
+#else
+  return !thread_pool->isStrandBusy(db_name) &&
+         opsqlite_should_use_reader(db_name, query);
+#endif
+}
+
+/// Whether a native transaction holds the strand of the database
+bool DBHostObject::in_transaction() {
+#ifdef OP_SQLITE_USE_LIBSQL
+  return false;
+#else
+  return transaction_slot->is_open();
+#endif
+}
+
+/// Work sent while a native transaction is open runs inside it, awaiting it
+/// from the transaction callback would otherwise never resolve
+std::string DBHostObject::work_strand() {
+#ifdef OP_SQLITE_USE_LIBSQL
+  return db_name;
+#else
+  return transaction_slot->strand(db_name);
+#endif
+}
+
+#ifndef OP_SQLITE_USE_LIBSQL
+/// Closing the database releases a native transaction left open, the work
+/// waiting for it then runs and fails instead of waiting for the transaction
+/// to be garbage collected
+void DBHostObject::abandon_transaction() {
+  auto transaction = transaction_slot->transaction.lock();
+  if (transaction != nullptr) {
+    transaction->abandon();
+  }
+}
+#endif
+
 #ifdef OP_SQLITE_USE_LIBSQL
 DBHostObject::DBHostObject(jsi::Runtime &rt, std::string &url,
                            std::string &auth_token,
@@ -172,28 +274,51 @@ DBHostObject::DBHostObject(jsi::Runtime &rt, std::string &base_path,
                            std::string &db_name, std::string &path,
                            std::string &crsqlite_path,
                            std::string &sqlite_vec_path,
-                           std::string &encryption_key)
+                           std::string &encryption_key, int reader_connections,
+                           bool owned_connection)
     : base_path(base_path), jsCallInvoker(jsCallInvoker),
       thread_pool(thread_pool), db_name(db_name), rt(rt) {
 
 #ifdef OP_SQLITE_USE_SQLCIPHER
-  BridgeResult result = opsqlite_open(db_name, path, crsqlite_path,
-                                      sqlite_vec_path, encryption_key);
+  BridgeResult result =
+      opsqlite_open(db_name, path, crsqlite_path, sqlite_vec_path,
+                    encryption_key, owned_connection);
 #elif OP_SQLITE_USE_LIBSQL
   BridgeResult result = opsqlite_libsql_open(db_name, path, crsqlite_path);
 #else
-  BridgeResult result =
-      opsqlite_open(db_name, path, crsqlite_path, sqlite_vec_path);
+  BridgeResult result = opsqlite_open(db_name, path, crsqlite_path,
+                                      sqlite_vec_path, owned_connection);
 #endif
 
   if (result.type == SQLiteError) {
     throw std::runtime_error(result.message);
   }
 
+#ifndef OP_SQLITE_USE_LIBSQL
+  if (reader_connections > 0) {
+#ifdef OP_SQLITE_USE_SQLCIPHER
+    result = opsqlite_open_readers(db_name, path, reader_connections,
+                                   encryption_key);
+#else
+    result = opsqlite_open_readers(db_name, path, reader_connections);
+#endif
+
+    if (result.type == SQLiteError) {
+      opsqlite_close(db_name);
+      throw std::runtime_error(result.message);
+    }
+  }
+#endif
+
   create_jsi_functions();
 };
 
 void DBHostObject::create_jsi_functions() {
+  completions = std::make_shared<CompletionQueue>(rt, jsCallInvoker);
+#ifndef OP_SQLITE_USE_LIBSQL
+  transaction_slot = std::make_shared<TransactionSlot>();
+#endif
+
   auto attach = HOSTFN("attach", 4) {
     if (count < 3) {
       throw jsi::JSError(rt,
@@ -262,6 +387,8 @@ void DBHostObject::create_jsi_functions() {
 #ifdef OP_SQLITE_USE_LIBSQL
     BridgeResult result = opsqlite_libsql_close(db_name);
 #else
+    seal_group_commit();
+    abandon_transaction();
     BridgeResult result = opsqlite_close(db_name);
 #endif
 
@@ -298,6 +425,7 @@ void DBHostObject::create_jsi_functions() {
 #ifdef OP_SQLITE_USE_LIBSQL
     BridgeResult result = opsqlite_libsql_remove(db_name, path);
 #else
+    abandon_transaction();
     BridgeResult result = opsqlite_remove(db_name, path);
 #endif
 
@@ -308,31 +436,67 @@ void DBHostObject::create_jsi_functions() {
     return {};
   });
 
-  auto execute = HOSTFN("execute", 2) {
+  auto execute = HOSTFN("execute", 3) {
     const std::string query = args[0].asString(rt).utf8(rt);
     std::vector<JSVariant> params;
 
-    if (count == 2) {
+    if (count >= 2) {
       const jsi::Value &originalParams = args[1];
-      params = to_variant_vec(rt, originalParams);
+      // Blocking call, the statement can read the JS buffers directly
+      params = to_variant_vec(rt, originalParams, true);
+    }
+
+    ExecuteOptions execute_options =
+        count == 3 ? to_execute_options(rt, args[2]) : ExecuteOptions();
+
+#ifndef OP_SQLITE_USE_LIBSQL
+    // Stopping the query while it runs needs the connection to itself, async
+    // calls of other threads may be running on a shared one
+    if (execute_options.cancellation != nullptr &&
+        !opsqlite_is_owned_connection(db_name)) {
+      throw std::runtime_error(
+          "[op-sqlite][execute] signal and timeoutMs need a database opened "
+          "with ownedConnection, use executeAsync instead");
     }
 
-    std::vector<DumbHostObject> results;
+    // Served from memory until one of the tables it read changes
+    std::string cache_key;
+    if (execute_options.cache && is_single_select(query)) {
+      cache_key = query_key(query, params, execute_options.big_ints);
+
+      CachedResult hit;
+      if (opsqlite_cached_result(db_name, cache_key, &hit)) {
+        return createResult(rt, hit.status, hit.results, hit.metadata,
+                            execute_options);
+      }
+    }
+#endif
+
+    auto results = std::make_shared<ResultBuffer>();
     std::shared_ptr<std::vector<SmartHostObject>> metadata =
         std::make_shared<std::vector<SmartHostObject>>();
 
+    seal_single_flight();
+
 #ifdef OP_SQLITE_USE_LIBSQL
-    auto status =
-        opsqlite_libsql_execute(db_name, query, &params, &results, metadata);
+    auto status = opsqlite_libsql_execute(db_name, query, &params,
+                                          results.get(), metadata);
 #else
-    auto status = opsqlite_execute(db_name, query, &params, &results, metadata);
+    auto status =
+        cache_key.empty()
+            ? opsqlite_execute(db_name, query, &params, results.get(),
+                               metadata, execute_options.cancellation.get())
+            : opsqlite_execute_cached(db_name, query, &params, cache_key,
+                                      false, results, metadata,
+                                      execute_options.cancellation.get());
 #endif
 
     if (status.type == SQLiteError) {
       throw std::runtime_error(status.message);
     }
 
-    auto jsiResult = createResult(rt, status, &results, metadata);
+    auto jsiResult =
+        createResult(rt, status, results, metadata, execute_options);
     return jsiResult;
   });
 
@@ -345,13 +509,15 @@ void DBHostObject::create_jsi_functions() {
       params = to_variant_vec(rt, originalParams);
     }
 
-    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto &promiseCtr = completions->promise_constructor();
     auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
       auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
       auto reject = std::make_shared<jsi::Value>(rt, args[1]);
 
+      bool use_reader = this->use_reader(query);
+
       auto task = [&rt, this, query, params = std::move(params), resolve,
-                   reject, invoker = this->jsCallInvoker]() {
+                   reject, completions = this->completions, use_reader]() {
         try {
           std::vector<std::vector<JSVariant>> results;
 
@@ -359,38 +525,44 @@ void DBHostObject::create_jsi_functions() {
           auto status =
               opsqlite_libsql_execute_raw(db_name, query, &params, &results);
 #else
-          auto status = opsqlite_execute_raw(db_name, query, &params, &results);
+          auto status =
+              use_reader
+                  ? opsqlite_execute_raw_read(db_name, query, &params, &results)
+                  : opsqlite_execute_raw(db_name, query, &params, &results);
 #endif
           //
           //            if (invalidated) {
           //              return;
           //            }
 
-          invoker->invokeAsync([&rt, results = std::move(results),
-                                status = std::move(status), resolve, reject] {
+          completions->push([&rt, completions, results = std::move(results),
+                             status = std::move(status), resolve, reject] {
             if (status.type == SQLiteOk) {
               auto jsiResult = create_raw_result(rt, status, &results);
               resolve->asObject(rt).asFunction(rt).call(rt,
                                                         std::move(jsiResult));
             } else {
-              auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
-              auto error = errorCtr.callAsConstructor(
-                  rt, jsi::String::createFromUtf8(rt, status.message));
+              auto error = completions->create_error(status.message);
               reject->asObject(rt).asFunction(rt).call(rt, error);
             }
           });
 
         } catch (std::exception &exc) {
-          invoker->invokeAsync([&rt, exc = std::move(exc), reject] {
-            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
-            auto error = errorCtr.callAsConstructor(
-                rt, jsi::String::createFromAscii(rt, exc.what()));
+          completions->push([&rt, completions, message = std::string(exc.what()),
+                             reject] {
+            auto error = completions->create_error(message);
             reject->asObject(rt).asFunction(rt).call(rt, error);
           });
         }
       };
 
-      thread_pool->queueWork(task);
+      // Reads on a read connection do not wait for the queue of the database
+      if (use_reader) {
+        thread_pool->queueWork(std::move(task));
+      } else {
+        seal_group_commit();
+        thread_pool->queueWork(work_strand(), std::move(task));
+      }
 
       return {};
      }));
@@ -398,67 +570,176 @@ void DBHostObject::create_jsi_functions() {
     return promise;
   });
 
-  auto execute_async = HOSTFN("executeAsync", 2) {
+  auto execute_async = HOSTFN("executeAsync", 3) {
     const std::string query = args[0].asString(rt).utf8(rt);
     std::vector<JSVariant> params;
 
-    if (count == 2) {
+    if (count >= 2) {
       const jsi::Value &originalParams = args[1];
       params = to_variant_vec(rt, originalParams);
     }
 
-    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    ExecuteOptions execute_options =
+        count == 3 ? to_execute_options(rt, args[2]) : ExecuteOptions();
+
+    auto &promiseCtr = completions->promise_constructor();
     auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
       auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
       auto reject = std::make_shared<jsi::Value>(rt, args[1]);
 
-      auto task = [&rt, this, query, params = std::move(params), resolve,
-                   reject, invoker = this->jsCallInvoker]() {
-        try {
-          std::vector<DumbHostObject> results;
-          std::shared_ptr<std::vector<SmartHostObject>> metadata =
-              std::make_shared<std::vector<SmartHostObject>>();
+      bool use_reader = this->use_reader(query);
+
+      auto settle = [&rt, resolve, reject, execute_options,
+                     invoker = this->jsCallInvoker,
+                     completions = this->completions](
+                        BridgeResult status,
+                        std::shared_ptr<ResultBuffer> results,
+                        std::shared_ptr<std::vector<SmartHostObject>> metadata) {
+        if (status.type == SQLiteOk && execute_options.chunk_budget_ms > 0 &&
+            !execute_options.lazy_rows) {
+          std::make_shared<ChunkedResult>(rt, invoker, status, results,
+                                          metadata, execute_options, resolve,
+                                          reject)
+              ->start();
+        } else if (status.type == SQLiteOk) {
+          auto jsiResult =
+              createResult(rt, status, results, metadata, execute_options);
+          resolve->asObject(rt).asFunction(rt).call(rt, std::move(jsiResult));
+        } else {
+          auto error = completions->create_error(status.message);
+          reject->asObject(rt).asFunction(rt).call(rt, error);
+        }
+      };
+
+#ifndef OP_SQLITE_USE_LIBSQL
+      // Small writes are committed together with the ones around them. A
+      // cancellable write is not, the others would share its fate, nor one
+      // sent while a transaction holds the database
+      if (!use_reader && group_commit != nullptr &&
+          execute_options.cancellation == nullptr &&
+          !in_transaction() &&
+          GroupCommit::can_coalesce(query)) {
+        auto results = std::make_shared<ResultBuffer>();
+        auto metadata = std::make_shared<std::vector<SmartHostObject>>();
+
+        group_commit->add(
+            {.query = query,
+             .params = params,
+             .results = results,
+             .metadata = metadata,
+             .callback = [settle, results, metadata,
+                          completions = this->completions](BridgeResult status) {
+               completions->push(
+                   [settle, results, metadata, status = std::move(status)] {
+                     settle(status, results, metadata);
+                   });
+             }});
+
+        return {};
+      }
+#endif
+
+      std::string key;
+      if ((execute_options.cache || single_flight != nullptr) &&
+          is_single_select(query)) {
+        key = query_key(query, params, execute_options.big_ints);
+      }
+
 #ifdef OP_SQLITE_USE_LIBSQL
-          auto status = opsqlite_libsql_execute(db_name, query, &params,
-                                                &results, metadata);
+      bool cached = false;
 #else
-          auto status =
-              opsqlite_execute(db_name, query, &params, &results, metadata);
+      // Served from memory until one of the tables it read changes. Work
+      // still queued on the database, writes waiting for a group commit
+      // included, has not invalidated anything yet, the read then waits its
+      // turn instead
+      bool cached = execute_options.cache && !key.empty();
+      CachedResult hit;
+      if (cached && !thread_pool->isStrandBusy(db_name) &&
+          opsqlite_cached_result(db_name, key, &hit)) {
+        settle(hit.status, hit.results, hit.metadata);
+        return {};
+      }
 #endif
 
-          //            if (invalidated) {
-          //              return;
-          //            }
+      // An identical read already queued or running answers this one too. A
+      // cancellable read runs on its own, cancelling it would reject the
+      // others, and so does one that sees the changes of an open transaction
+      std::shared_ptr<SingleFlight::Flight> flight;
+      if (single_flight != nullptr && execute_options.cancellation == nullptr &&
+          !key.empty() && !in_transaction()) {
+        if (single_flight->join(key, settle)) {
+          return {};
+        }
+        flight = single_flight->start(key);
+      }
 
-          invoker->invokeAsync(
-              [&rt,
-               results = std::make_shared<std::vector<DumbHostObject>>(results),
-               metadata, status = std::move(status), resolve, reject] {
-                if (status.type == SQLiteOk) {
-                  auto jsiResult =
-                      createResult(rt, status, results.get(), metadata);
-                  resolve->asObject(rt).asFunction(rt).call(
-                      rt, std::move(jsiResult));
-                } else {
-                  auto errorCtr =
-                      rt.global().getPropertyAsFunction(rt, "Error");
-                  auto error = errorCtr.callAsConstructor(
-                      rt, jsi::String::createFromUtf8(rt, status.message));
-                  reject->asObject(rt).asFunction(rt).call(rt, error);
-                }
-              });
+      auto task = [this, query, params = std::move(params), settle,
+                   completions = this->completions, use_reader,
+                   cancellation = execute_options.cancellation,
+                   single_flight = this->single_flight, key, cached,
+                   flight]() {
+        auto results = std::make_shared<ResultBuffer>();
+        std::shared_ptr<std::vector<SmartHostObject>> metadata =
+            std::make_shared<std::vector<SmartHostObject>>();
+        BridgeResult status;
 
+        try {
+          // Cancelled or timed out while queued, the query is dropped
+          if (cancellation != nullptr && cancellation->should_stop()) {
+            status = {.type = SQLiteError, .message = cancellation->reason()};
+          } else {
+#ifdef OP_SQLITE_USE_LIBSQL
+            status = opsqlite_libsql_execute(db_name, query, &params,
+                                             results.get(), metadata);
+#else
+            if (cached) {
+              status = opsqlite_execute_cached(db_name, query, &params, key,
+                                               use_reader, results, metadata,
+                                               cancellation.get());
+            } else if (use_reader) {
+              status = opsqlite_execute_read(db_name, query, &params,
+                                             results.get(), metadata,
+                                             cancellation.get());
+            } else {
+              status = opsqlite_execute(db_name, query, &params, results.get(),
+                                        metadata, cancellation.get());
+            }
+#endif
+          }
         } catch (std::exception &exc) {
-          invoker->invokeAsync([&rt, exc = std::move(exc), reject] {
-            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
-            auto error = errorCtr.callAsConstructor(
-                rt, jsi::String::createFromAscii(rt, exc.what()));
-            reject->asObject(rt).asFunction(rt).call(rt, error);
-          });
+          status = {.type = SQLiteError, .message = exc.what()};
         }
+
+        //            if (invalidated) {
+        //              return;
+        //            }
+
+        completions->push([settle, results, metadata,
+                           status = std::move(status), single_flight, key,
+                           flight] {
+          std::vector<FlightCallback> followers;
+          if (flight != nullptr) {
+            followers = single_flight->land(key, flight);
+          }
+          if (!followers.empty()) {
+            results->copy_blobs = true;
+          }
+
+          settle(status, results, metadata);
+          for (auto &follower : followers) {
+            follower(status, results, metadata);
+          }
+        });
       };
 
-      thread_pool->queueWork(task);
+      // Reads on a read connection do not wait for the queue of the database
+      if (use_reader) {
+        thread_pool->queueWork(std::move(task), execute_options.priority);
+      } else {
+        seal_group_commit(flight != nullptr);
+        thread_pool->queueWork(work_strand(), std::move(task),
+                               execute_options.priority);
+      }
 
       return {};
       }));
@@ -466,7 +747,7 @@ void DBHostObject::create_jsi_functions() {
     return promise;
   });
 
-  auto execute_batch = HOSTFN("executeBatch", 1) {
+  auto execute_batch = HOSTFN("executeBatch", 2) {
     if (sizeof(args) < 1) {
       throw std::runtime_error(
           "[op-sqlite][executeBatch] - Incorrect parameter count");
@@ -481,10 +762,14 @@ void DBHostObject::create_jsi_functions() {
     std::vector<BatchArguments> commands;
     to_batch_arguments(rt, batchParams, &commands);
 
+    seal_single_flight();
+
 #ifdef OP_SQLITE_USE_LIBSQL
     auto batchResult = opsqlite_libsql_execute_batch(db_name, &commands);
 #else
-    auto batchResult = opsqlite_execute_batch(db_name, &commands);
+    auto batchResult = opsqlite_execute_batch(
+        db_name, &commands,
+        count > 1 ? to_batch_options(rt, args[1]) : BatchOptions());
 #endif
     if (batchResult.type == SQLiteOk) {
       auto res = jsi::Object(rt);
@@ -495,7 +780,7 @@ void DBHostObject::create_jsi_functions() {
     }
   });
 
-  auto execute_batch_async = HOSTFN("executeBatchAsync", 1) {
+  auto execute_batch_async = HOSTFN("executeBatchAsync", 2) {
     if (sizeof(args) < 1) {
       throw std::runtime_error(
           "[op-sqlite][executeAsyncBatch] Incorrect parameter count");
@@ -516,6 +801,12 @@ void DBHostObject::create_jsi_functions() {
     std::vector<BatchArguments> commands;
     to_batch_arguments(rt, batchParams, &commands);
 
+#ifndef OP_SQLITE_USE_LIBSQL
+    auto options = count > 1 ? to_batch_options(rt, args[1]) : BatchOptions();
+#endif
+    TaskPriority priority =
+        count > 1 ? to_task_priority(rt, args[1]) : NormalPriority;
+
     auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
      auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
       auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
@@ -524,13 +815,17 @@ void DBHostObject::create_jsi_functions() {
       auto task = [&rt, this,
                    commands =
                        std::make_shared<std::vector<BatchArguments>>(commands),
+#ifndef OP_SQLITE_USE_LIBSQL
+                   options,
+#endif
                    resolve, reject]() {
         try {
 #ifdef OP_SQLITE_USE_LIBSQL
           auto batchResult =
               opsqlite_libsql_execute_batch(db_name, commands.get());
 #else
-          auto batchResult = opsqlite_execute_batch(db_name, commands.get());
+          auto batchResult =
+              opsqlite_execute_batch(db_name, commands.get(), options);
 #endif
           jsCallInvoker->invokeAsync([&rt, batchResult = std::move(batchResult),
                                       resolve, reject] {
@@ -551,7 +846,8 @@ void DBHostObject::create_jsi_functions() {
               [&rt, reject, &exc] { throw jsi::JSError(rt, exc.what()); });
         }
       };
-      thread_pool->queueWork(task);
+      seal_group_commit();
+      thread_pool->queueWork(work_strand(), std::move(task), priority);
 
       return {};
             }));
@@ -609,7 +905,10 @@ void DBHostObject::create_jsi_functions() {
               [&rt, err = exc.what(), reject] { throw jsi::JSError(rt, err); });
         }
       };
-      thread_pool->queueWork(task);
+      seal_group_commit();
+      // Imports are bulk work, interactive queries on the readers go first
+      thread_pool->queueWork(work_strand(), std::move(task),
+                             BackgroundPriority);
       return {};
                }));
 
@@ -708,7 +1007,7 @@ void DBHostObject::create_jsi_functions() {
     auto variant_args = to_variant_vec(rt, js_args);
 
     sqlite3_stmt *stmt = opsqlite_prepare_statement(db_name, query_str);
-    opsqlite_bind_statement(stmt, &variant_args);
+    opsqlite_bind_statement(db_name, stmt, &variant_args);
 
     auto callback =
         std::make_shared<jsi::Value>(query.getProperty(rt, "callback"));
@@ -761,8 +1060,266 @@ void DBHostObject::create_jsi_functions() {
     return unsubscribe;
   });
 
+  auto get_statement_cache_stats = HOSTFN("getStatementCacheStats", 0) {
+    auto stats = opsqlite_get_statement_cache_stats(db_name);
+
+    auto res = jsi::Object(rt);
+    res.setProperty(rt, "hits", jsi::Value(static_cast<double>(stats.hits)));
+    res.setProperty(rt, "misses",
+                    jsi::Value(static_cast<double>(stats.misses)));
+    res.setProperty(rt, "evictions",
+                    jsi::Value(static_cast<double>(stats.evictions)));
+    res.setProperty(rt, "size", jsi::Value(static_cast<double>(stats.size)));
+    res.setProperty(rt, "memory",
+                    jsi::Value(static_cast<double>(stats.memory)));
+    return res;
+  });
+
+  auto set_result_cache = HOSTFN("setResultCache", 1) {
+    ResultCacheOptions options;
+
+    if (count > 0 && args[0].isObject()) {
+      auto options_obj = args[0].asObject(rt);
+      options.max_entries = 100;
+
+      auto max_entries = options_obj.getProperty(rt, "maxEntries");
+      if (max_entries.isNumber()) {
+        options.max_entries = static_cast<size_t>(max_entries.asNumber());
+      }
+
+      auto max_bytes = options_obj.getProperty(rt, "maxBytes");
+      if (max_bytes.isNumber()) {
+        options.max_memory = static_cast<size_t>(max_bytes.asNumber());
+      }
+
+      auto ttl = options_obj.getProperty(rt, "ttlMs");
+      if (ttl.isNumber()) {
+        options.ttl = std::chrono::milliseconds(
+            static_cast<int64_t>(ttl.asNumber()));
+      }
+    } else if (count > 0 && !args[0].isNull() && !args[0].isUndefined()) {
+      throw std::runtime_error(
+          "[op-sqlite][setResultCache] options must be an object or null");
+    }
+
+    opsqlite_set_result_cache(db_name, options);
+    return {};
+  });
+
+  auto get_result_cache_stats = HOSTFN("getResultCacheStats", 0) {
+    auto stats = opsqlite_get_result_cache_stats(db_name);
+    size_t lookups = stats.hits + stats.misses;
+
+    auto res = jsi::Object(rt);
+    res.setProperty(rt, "hits", jsi::Value(static_cast<double>(stats.hits)));
+    res.setProperty(rt, "misses",
+                    jsi::Value(static_cast<double>(stats.misses)));
+    res.setProperty(rt, "hitRatio",
+                    jsi::Value(lookups > 0 ? static_cast<double>(stats.hits) /
+                                                 static_cast<double>(lookups)
+                                           : 0.0));
+    res.setProperty(rt, "invalidations",
+                    jsi::Value(static_cast<double>(stats.invalidations)));
+    res.setProperty(rt, "evictions",
+                    jsi::Value(static_cast<double>(stats.evictions)));
+    res.setProperty(rt, "size", jsi::Value(static_cast<double>(stats.size)));
+    res.setProperty(rt, "memory",
+                    jsi::Value(static_cast<double>(stats.memory)));
+    return res;
+  });
+
+  auto insert_columns = HOSTFN("insertColumns", 2) {
+    if (count < 2 || !args[0].isString() || !args[1].isObject()) {
+      throw std::runtime_error("[op-sqlite][insertColumns] a table name and "
+                               "an object of columns are needed");
+    }
+
+    const std::string table = args[0].asString(rt).utf8(rt);
+    size_t rows = 0;
+    // Blocking call, the typed arrays are read in place
+    auto columns = to_column_values(rt, args[1].asObject(rt), true, &rows);
+
+    seal_single_flight();
+    auto result = opsqlite_insert_columns(db_name, table, columns, rows);
+
+    if (result.type == SQLiteError) {
+      throw std::runtime_error(result.message);
+    }
+
+    auto res = jsi::Object(rt);
+    res.setProperty(rt, "rowsAffected", jsi::Value(result.affectedRows));
+    return res;
+  });
+
+  auto insert_columns_async = HOSTFN("insertColumnsAsync", 2) {
+    if (count < 2 || !args[0].isString() || !args[1].isObject()) {
+      throw std::runtime_error("[op-sqlite][insertColumnsAsync] a table name "
+                               "and an object of columns are needed");
+    }
+
+    const std::string table = args[0].asString(rt).utf8(rt);
+    size_t rows = 0;
+    auto columns = std::make_shared<std::vector<ColumnValues>>(
+        to_column_values(rt, args[1].asObject(rt), false, &rows));
+
+    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+      auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+      auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+      auto task = [&rt, this, table, columns, rows, resolve, reject]() {
+        BatchResult result;
+
+        // Closed meanwhile, the promise is still rejected
+        try {
+          result = opsqlite_insert_columns(db_name, table, *columns, rows);
+        } catch (std::exception &exc) {
+          result = {.type = SQLiteError, .message = exc.what()};
+        }
+
+        jsCallInvoker->invokeAsync(
+            [&rt, result = std::move(result), resolve, reject] {
+              if (result.type == SQLiteOk) {
+                auto res = jsi::Object(rt);
+                res.setProperty(rt, "rowsAffected",
+                                jsi::Value(result.affectedRows));
+                resolve->asObject(rt).asFunction(rt).call(rt, std::move(res));
+              } else {
+                auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+                auto error = errorCtr.callAsConstructor(
+                    rt, jsi::String::createFromUtf8(rt, result.message));
+                reject->asObject(rt).asFunction(rt).call(rt, error);
+              }
+            });
+      };
+
+      seal_group_commit();
+      thread_pool->queueWork(work_strand(), std::move(task));
+
+      return {};
+    }));
+
+    return promise;
+  });
+
+  auto begin_transaction = HOSTFN("beginTransaction", 0) {
+    auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+    auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+      auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+      auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+
+      auto transaction = std::make_shared<TransactionHostObject>(
+          rt, db_name, jsCallInvoker, thread_pool);
+
+      seal_group_commit();
+      transaction->begin([&rt, transaction, resolve, reject,
+                          invoker = jsCallInvoker,
+                          slot = transaction_slot](BridgeResult status) {
+        invoker->invokeAsync([&rt, transaction, status = std::move(status),
+                              resolve, reject, slot] {
+          if (status.type == SQLiteOk) {
+            // The work of the database sent from now on runs inside it
+            slot->transaction = transaction;
+            resolve->asObject(rt).asFunction(rt).call(
+                rt, jsi::Object::createFromHostObject(rt, transaction));
+          } else {
+            auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+            auto error = errorCtr.callAsConstructor(
+                rt, jsi::String::createFromUtf8(rt, status.message));
+            reject->asObject(rt).asFunction(rt).call(rt, error);
+          }
+        });
+      });
+
+      return {};
+    }));
+
+    return promise;
+  });
+
+  auto set_group_commit = HOSTFN("setGroupCommit", 1) {
+    seal_group_commit();
+
+    if (count == 0 || args[0].isNull() || args[0].isUndefined()) {
+      group_commit = nullptr;
+      return {};
+    }
+
+    if (!args[0].isObject()) {
+      throw std::runtime_error(
+          "[op-sqlite][setGroupCommit] options must be an object or null");
+    }
+
+    auto options = args[0].asObject(rt);
+    double window_ms = 2;
+    double max_writes = 100;
+
+    auto window_prop = options.getProperty(rt, "windowMs");
+    if (window_prop.isNumber()) {
+      window_ms = window_prop.asNumber();
+    }
+
+    auto max_writes_prop = options.getProperty(rt, "maxWrites");
+    if (max_writes_prop.isNumber()) {
+      max_writes = max_writes_prop.asNumber();
+    }
+
+    if (window_ms < 0 || max_writes < 1) {
+      throw std::runtime_error(
+          "[op-sqlite][setGroupCommit] windowMs must not be negative and "
+          "maxWrites must be at least 1");
+    }
+
+    group_commit = std::make_shared<GroupCommit>(
+        db_name, thread_pool,
+        std::chrono::milliseconds(static_cast<int64_t>(window_ms)),
+        static_cast<size_t>(max_writes));
+
+    return {};
+  });
+
+  auto open_cursor = HOSTFN("openCursor", 2) {
+    const std::string query = args[0].asString(rt).utf8(rt);
+    std::vector<JSVariant> params;
+
+    if (count == 2) {
+      params = to_variant_vec(rt, args[1], true);
+    }
+
+    sqlite3_stmt *statement = opsqlite_prepare_statement(db_name, query);
+    // Blank queries and comments prepare fine but give no statement
+    if (statement == nullptr) {
+      throw std::runtime_error(
+          "[op-sqlite][openCursor] query does not contain a statement");
+    }
+    opsqlite_bind_statement(db_name, statement, &params);
+
+    auto cursor = std::make_shared<CursorHostObject>(
+        rt, db_name, statement, jsCallInvoker, thread_pool, transaction_slot);
+
+    return jsi::Object::createFromHostObject(rt, cursor);
+  });
+
 #endif
 
+  auto set_single_flight = HOSTFN("setSingleFlight", 1) {
+    if (count == 0 || !args[0].isBool()) {
+      throw std::runtime_error(
+          "[op-sqlite][setSingleFlight] enabled must be a boolean");
+    }
+
+    // Reads in flight still settle the callers that joined them
+    if (args[0].getBool()) {
+      if (single_flight == nullptr) {
+        single_flight = std::make_shared<SingleFlight>();
+      }
+    } else {
+      single_flight = nullptr;
+    }
+
+    return {};
+  });
+
   auto prepare_statement = HOSTFN("prepareStatement", 1) {
     auto query = args[0].asString(rt).utf8(rt);
 #ifdef OP_SQLITE_USE_LIBSQL
@@ -810,6 +1367,7 @@ void DBHostObject::create_jsi_functions() {
   function_map["executeBatchAsync"] = std::move(execute_batch_async);
   function_map["prepareStatement"] = std::move(prepare_statement);
   function_map["getDbPath"] = std::move(get_db_path);
+  function_map["setSingleFlight"] = std::move(set_single_flight);
 #ifdef OP_SQLITE_USE_LIBSQL
   function_map["sync"] = std::move(sync);
 #else
@@ -819,6 +1377,14 @@ void DBHostObject::create_jsi_functions() {
   function_map["rollbackHook"] = std::move(rollback_hook);
   function_map["loadExtension"] = std::move(load_extension);
   function_map["reactiveExecute"] = std::move(reactive_execute);
+  function_map["getStatementCacheStats"] = std::move(get_statement_cache_stats);
+  function_map["setResultCache"] = std::move(set_result_cache);
+  function_map["getResultCacheStats"] = std::move(get_result_cache_stats);
+  function_map["openCursor"] = std::move(open_cursor);
+  function_map["setGroupCommit"] = std::move(set_group_commit);
+  function_map["beginTransaction"] = std::move(begin_transaction);
+  function_map["insertColumns"] = std::move(insert_columns);
+  function_map["insertColumnsAsync"] = std::move(insert_columns_async);
 #endif
 }
 
@@ -868,6 +1434,9 @@ jsi::Value DBHostObject::get(jsi::Runtime &rt,
   if (name == "sync") {
     return jsi::Value(rt, function_map["sync"]);
   }
+  if (name == "setSingleFlight") {
+    return jsi::Value(rt, function_map["setSingleFlight"]);
+  }
 #ifdef OP_SQLITE_USE_LIBSQL
   if (name == "loadFile") {
     return HOSTFN("loadFile", 0) {
@@ -899,6 +1468,41 @@ jsi::Value DBHostObject::get(jsi::Runtime &rt,
       throw std::runtime_error("[op-sqlite] Hooks not supported in libsql");
     });
   }
+  if (name == "getStatementCacheStats") {
+    return HOSTFN("getStatementCacheStats", 0) {
+      throw std::runtime_error(
+          "[op-sqlite] Statement cache not supported in libsql");
+    });
+  }
+  if (name == "setResultCache" || name == "getResultCacheStats") {
+    return HOSTFN(name.c_str(), 0) {
+      throw std::runtime_error(
+          "[op-sqlite] Result cache not supported in libsql");
+    });
+  }
+  if (name == "openCursor") {
+    return HOSTFN("openCursor", 0) {
+      throw std::runtime_error("[op-sqlite] Cursors not supported in libsql");
+    });
+  }
+  if (name == "setGroupCommit") {
+    return HOSTFN("setGroupCommit", 0) {
+      throw std::runtime_error(
+          "[op-sqlite] Group commit not supported in libsql");
+    });
+  }
+  if (name == "beginTransaction") {
+    return HOSTFN("beginTransaction", 0) {
+      throw std::runtime_error(
+          "[op-sqlite] Native transactions not supported in libsql");
+    });
+  }
+  if (name == "insertColumns" || name == "insertColumnsAsync") {
+    return HOSTFN(name.c_str(), 0) {
+      throw std::runtime_error(
+          "[op-sqlite] Columnar inserts not supported in libsql");
+    });
+  }
 #else
   if (name == "loadFile") {
     return jsi::Value(rt, function_map["loadFile"]);
@@ -918,6 +1522,30 @@ jsi::Value DBHostObject::get(jsi::Runtime &rt,
   if (name == "reactiveExecute") {
     return jsi::Value(rt, function_map["reactiveExecute"]);
   }
+  if (name == "getStatementCacheStats") {
+    return jsi::Value(rt, function_map["getStatementCacheStats"]);
+  }
+  if (name == "setResultCache") {
+    return jsi::Value(rt, function_map["setResultCache"]);
+  }
+  if (name == "getResultCacheStats") {
+    return jsi::Value(rt, function_map["getResultCacheStats"]);
+  }
+  if (name == "openCursor") {
+    return jsi::Value(rt, function_map["openCursor"]);
+  }
+  if (name == "setGroupCommit") {
+    return jsi::Value(rt, function_map["setGroupCommit"]);
+  }
+  if (name == "beginTransaction") {
+    return jsi::Value(rt, function_map["beginTransaction"]);
+  }
+  if (name == "insertColumns") {
+    return jsi::Value(rt, function_map["insertColumns"]);
+  }
+  if (name == "insertColumnsAsync") {
+    return jsi::Value(rt, function_map["insertColumnsAsync"]);
+  }
 #endif
 
   return {};
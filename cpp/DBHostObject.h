@@ -14,6 +14,11 @@ namespace opsqlite {
 namespace jsi = facebook::jsi;
 namespace react = facebook::react;
 
+class GroupCommit;
+class CompletionQueue;
+class SingleFlight;
+struct TransactionSlot;
+
 struct TableRowDiscriminator {
   std::string table;
   std::vector<int> ids;
@@ -32,7 +37,8 @@ public:
                std::shared_ptr<react::CallInvoker> js_call_invoker,
                std::shared_ptr<ThreadPool> thread_pool, std::string &db_name,
                std::string &path, std::string &crsqlite_path,
-               std::string &sqlite_vec_path, std::string &encryption_key);
+               std::string &sqlite_vec_path, std::string &encryption_key,
+               int reader_connections, bool owned_connection);
 
 #ifdef OP_SQLITE_USE_LIBSQL
   // Constructor for remoteOpen, purely for remote databases
@@ -55,6 +61,12 @@ public:
 private:
   void auto_register_update_hook();
   void create_jsi_functions();
+  void seal_group_commit(bool shared_read = false);
+  void seal_single_flight();
+  bool use_reader(std::string const &query);
+  bool in_transaction();
+  std::string work_strand();
+  void abandon_transaction();
 
   std::unordered_map<std::string, jsi::Value> function_map;
   std::string base_path;
@@ -68,6 +80,10 @@ private:
   jsi::Runtime &rt;
   std::vector<std::shared_ptr<ReactiveQuery>> reactive_queries;
   bool is_update_hook_registered = false;
+  std::shared_ptr<GroupCommit> group_commit;
+  std::shared_ptr<CompletionQueue> completions;
+  std::shared_ptr<SingleFlight> single_flight;
+  std::shared_ptr<TransactionSlot> transaction_slot;
 };
 
 } // namespace opsqlite
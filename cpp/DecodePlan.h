@@ -0,0 +1,164 @@
+#pragma once
+
+#include "sqlite3.h"
+#include <cstring>
+#include <strings.h>
+#include <vector>
+
+namespace opsqlite {
+
+/// Reads a value of a known storage class into the sink, which takes it with
+/// add_null, add_integer, add_double, add_text and add_blob
+template <typename Sink>
+inline void decode_value(sqlite3_stmt *statement, int column, int type,
+                         Sink &sink) {
+  switch (type) {
+  case SQLITE_INTEGER:
+    sink.add_integer(sqlite3_column_int64(statement, column));
+    break;
+
+  case SQLITE_FLOAT:
+    sink.add_double(sqlite3_column_double(statement, column));
+    break;
+
+  case SQLITE_TEXT: {
+    const char *text =
+        reinterpret_cast<const char *>(sqlite3_column_text(statement, column));
+    // Specify length too; in case string contains NULL in the middle
+    sink.add_text(text, sqlite3_column_bytes(statement, column));
+    break;
+  }
+
+  case SQLITE_BLOB: {
+    const void *blob = sqlite3_column_blob(statement, column);
+    sink.add_blob(blob, sqlite3_column_bytes(statement, column));
+    break;
+  }
+
+  case SQLITE_NULL:
+  default:
+    sink.add_null();
+    break;
+  }
+}
+
+template <typename Sink>
+void decode_any(sqlite3_stmt *statement, int column, Sink &sink) {
+  decode_value(statement, column, sqlite3_column_type(statement, column), sink);
+}
+
+/// Decoder of a column expected to hold Type. Since SQLite is dynamically
+/// typed the storage class is still checked, other values fall back to the
+/// generic switch
+template <typename Sink, int Type>
+void decode_expected(sqlite3_stmt *statement, int column, Sink &sink) {
+  int type = sqlite3_column_type(statement, column);
+
+  if (type != Type) {
+    decode_value(statement, column, type, sink);
+    return;
+  }
+
+  decode_value(statement, column, Type, sink);
+}
+
+/// How each column of a statement is read, worked out once before the first
+/// row is decoded instead of switching on the column type of every cell.
+/// Columns get a decoder specialized for the storage class that their
+/// declared type suggests, or for the one found in the first row when the
+/// type says nothing (expressions, NUMERIC columns)
+template <typename Sink> class DecodePlan {
+public:
+  bool compiled() const { return is_compiled; }
+  size_t size() const { return decoders.size(); }
+
+  /// Called once the first row has been stepped, at most columns columns are
+  /// decoded
+  void compile(sqlite3_stmt *statement, size_t columns) {
+    size_t count = static_cast<size_t>(sqlite3_column_count(statement));
+    if (columns < count) {
+      count = columns;
+    }
+
+    decoders.clear();
+    decoders.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+      int column = static_cast<int>(i);
+      int type =
+          declared_storage_class(sqlite3_column_decltype(statement, column));
+
+      if (type == SQLITE_NULL) {
+        type = sqlite3_column_type(statement, column);
+      }
+
+      decoders.push_back(decoder_for(type));
+    }
+
+    is_compiled = true;
+  }
+
+  void decode(sqlite3_stmt *statement, Sink &sink) const {
+    size_t count = decoders.size();
+
+    for (size_t i = 0; i < count; i++) {
+      decoders[i](statement, static_cast<int>(i), sink);
+    }
+  }
+
+private:
+  using Decoder = void (*)(sqlite3_stmt *, int, Sink &);
+
+  /// Storage class implied by the affinity rules of SQLite for a declared
+  /// type, SQLITE_NULL when it can hold anything
+  static int declared_storage_class(const char *declared_type) {
+    if (declared_type == nullptr) {
+      return SQLITE_NULL;
+    }
+
+    auto contains = [declared_type](const char *word) {
+      size_t length = strlen(word);
+      for (const char *c = declared_type; *c != '\0'; c++) {
+        if (strncasecmp(c, word, length) == 0) {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    if (contains("INT")) {
+      return SQLITE_INTEGER;
+    }
+    if (contains("CHAR") || contains("CLOB") || contains("TEXT")) {
+      return SQLITE_TEXT;
+    }
+    if (contains("BLOB")) {
+      return SQLITE_BLOB;
+    }
+    if (contains("REAL") || contains("FLOA") || contains("DOUB")) {
+      return SQLITE_FLOAT;
+    }
+
+    return SQLITE_NULL;
+  }
+
+  static Decoder decoder_for(int type) {
+    switch (type) {
+    case SQLITE_INTEGER:
+      return &decode_expected<Sink, SQLITE_INTEGER>;
+    case SQLITE_FLOAT:
+      return &decode_expected<Sink, SQLITE_FLOAT>;
+    case SQLITE_TEXT:
+      return &decode_expected<Sink, SQLITE_TEXT>;
+    case SQLITE_BLOB:
+      return &decode_expected<Sink, SQLITE_BLOB>;
+    default:
+      return &decode_any<Sink>;
+    }
+  }
+
+  std::vector<Decoder> decoders;
+  bool is_compiled = false;
+};
+
+} // namespace opsqlite
@@ -1,5 +1,4 @@
 #include "DumbHostObject.h"
-#include "SmartHostObject.h"
 #include "utils.h"
 #include <iostream>
 
@@ -7,58 +6,49 @@ namespace opsqlite {
 
 namespace jsi = facebook::jsi;
 
-DumbHostObject::DumbHostObject(
-    std::shared_ptr<std::vector<SmartHostObject>> metadata) {
-  this->metadata = metadata;
-};
+DumbHostObject::DumbHostObject(std::shared_ptr<ResultBuffer> buffer,
+                               size_t row)
+    : buffer(std::move(buffer)), row(row){};
 
 std::vector<jsi::PropNameID>
 DumbHostObject::getPropertyNames(jsi::Runtime &rt) {
-  std::vector<jsi::PropNameID> keys;
-
-  for (auto field : *metadata) {
-    // TODO improve this by generating the propName once on metadata creation
-    keys.push_back(jsi::PropNameID::forAscii(
-        rt, std::get<std::string>(field.fields[0].second)));
+  if (buffer->columns == nullptr) {
+    return {};
   }
 
-  return keys;
+  return buffer->columns->prop_names(rt);
 }
 
 jsi::Value DumbHostObject::get(jsi::Runtime &rt,
                                const jsi::PropNameID &propNameID) {
-
-  auto name = propNameID.utf8(rt);
-  auto fields = metadata.get();
-  for (int i = 0; i < fields->size(); i++) {
-    auto fieldName = std::get<std::string>(fields->at(i).fields[0].second);
-    if (fieldName == name) {
-      return toJSI(rt, values.at(i));
+  // Only rows written from JS pay for converting the name to a string
+  if (!ownValues.empty()) {
+    auto name = propNameID.utf8(rt);
+
+    for (auto const &pairField : ownValues) {
+      if (name == pairField.first) {
+        return toJSI(rt, pairField.second);
+      }
     }
   }
 
-  for (auto pairField : ownValues) {
-    if (name == pairField.first) {
-      return toJSI(rt, pairField.second);
-    }
+  if (buffer->columns == nullptr) {
+    return {};
+  }
+
+  size_t column = buffer->columns->find(rt, propNameID);
+  if (column == ColumnDictionary::npos) {
+    return {};
   }
 
-  return {};
+  return buffer->get_value(rt, row, column);
 }
 
 void DumbHostObject::set(jsi::Runtime &rt, const jsi::PropNameID &name,
                          const jsi::Value &value) {
   auto key = name.utf8(rt);
-  auto fields = metadata.get();
-  for (int i = 0; i < fields->size(); i++) {
-    auto fieldName = std::get<std::string>(fields->at(i).fields[0].second);
-    if (fieldName == key) {
-      values[i] = toVariant(rt, value);
-      return;
-    }
-  }
 
-  for (auto pairField : ownValues) {
+  for (auto &pairField : ownValues) {
     if (key == pairField.first) {
       pairField.second = toVariant(rt, value);
       return;
@@ -3,7 +3,7 @@
 
 #include <stdio.h>
 
-#include "SmartHostObject.h"
+#include "ResultBuffer.h"
 #include "types.h"
 #include <any>
 #include <jsi/jsi.h>
@@ -13,11 +13,11 @@ namespace opsqlite {
 
 namespace jsi = facebook::jsi;
 
+/// A row of a result set, it does not own any data and only points to its
+/// place in the shared ResultBuffer
 class JSI_EXPORT DumbHostObject : public jsi::HostObject {
 public:
-  DumbHostObject(){};
-
-  DumbHostObject(std::shared_ptr<std::vector<SmartHostObject>> metadata);
+  DumbHostObject(std::shared_ptr<ResultBuffer> buffer, size_t row);
 
   std::vector<jsi::PropNameID> getPropertyNames(jsi::Runtime &rt);
 
@@ -26,10 +26,11 @@ public:
   void set(jsi::Runtime &rt, const jsi::PropNameID &name,
            const jsi::Value &value);
 
-  std::vector<JSVariant> values;
+  std::shared_ptr<ResultBuffer> buffer;
 
-  std::shared_ptr<std::vector<SmartHostObject>> metadata;
+  size_t row;
 
+  // Values written from JS, they shadow the columns of the result set
   std::vector<std::pair<std::string, JSVariant>> ownValues;
 };
 
@@ -0,0 +1,229 @@
+#include "GroupCommit.h"
+#include "bridge.h"
+#include <strings.h>
+
+namespace opsqlite {
+
+GroupCommit::GroupCommit(std::string db_name,
+                         std::shared_ptr<ThreadPool> thread_pool,
+                         std::chrono::milliseconds window, size_t max_writes)
+    : db_name(std::move(db_name)), thread_pool(std::move(thread_pool)),
+      window(window), max_writes(max_writes){};
+
+GroupCommit::~GroupCommit() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  deadline_changed.notify_all();
+
+  if (timer.joinable()) {
+    timer.join();
+  }
+}
+
+bool GroupCommit::can_coalesce(std::string const &query) {
+  const char *sql = query.c_str();
+  while (isspace(static_cast<unsigned char>(*sql))) {
+    sql++;
+  }
+
+  bool is_write = false;
+  for (const char *keyword : {"INSERT", "UPDATE", "DELETE", "REPLACE"}) {
+    size_t length = strlen(keyword);
+    if (strncasecmp(sql, keyword, length) == 0 &&
+        !isalnum(static_cast<unsigned char>(sql[length]))) {
+      is_write = true;
+      break;
+    }
+  }
+
+  if (!is_write) {
+    return false;
+  }
+
+  // Several statements in one query are left alone, a trailing semicolon is
+  // fine
+  const char *separator = strchr(sql, ';');
+  if (separator == nullptr) {
+    return true;
+  }
+
+  separator++;
+  while (isspace(static_cast<unsigned char>(*separator))) {
+    separator++;
+  }
+  return *separator == '\0';
+}
+
+void GroupCommit::add(GroupCommitWrite write) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (open_batch == nullptr) {
+    open_batch = std::make_shared<Batch>();
+    open_batch->deadline = std::chrono::steady_clock::now() + window;
+    open_batch->owner = shared_from_this();
+
+    // Only takes the turn of the batch on the strand, the work queued after
+    // it waits until the batch is flushed
+    thread_pool->queueWork(db_name,
+                           [this, batch = open_batch] { hold(batch); });
+
+    if (!timer.joinable()) {
+      timer = std::thread(&GroupCommit::watch_deadlines, this);
+    }
+    deadline_changed.notify_all();
+  }
+
+  open_batch->writes.push_back(std::move(write));
+
+  if (open_batch->writes.size() >= max_writes) {
+    close(open_batch);
+  }
+}
+
+void GroupCommit::seal() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (open_batch != nullptr) {
+    close(open_batch);
+  }
+}
+
+void GroupCommit::hold(std::shared_ptr<Batch> const &batch) {
+  thread_pool->holdStrand(db_name);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  batch->held = true;
+  if (batch->closed) {
+    queue_flush(batch);
+  }
+}
+
+void GroupCommit::close(std::shared_ptr<Batch> batch) {
+  batch->closed = true;
+  if (open_batch == batch) {
+    open_batch = nullptr;
+  }
+  if (batch->held) {
+    queue_flush(batch);
+  }
+}
+
+void GroupCommit::queue_flush(std::shared_ptr<Batch> const &batch) {
+  // Not queued on the strand, which is held for it
+  thread_pool->queueWork(
+      [self = std::move(batch->owner), batch] { self->flush(batch); });
+}
+
+void GroupCommit::flush(std::shared_ptr<Batch> const &batch) {
+  std::vector<GroupCommitWrite> writes;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    writes = std::move(batch->writes);
+  }
+
+  commit(writes);
+  thread_pool->releaseStrand(db_name);
+}
+
+void GroupCommit::watch_deadlines() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (!stopping) {
+    if (open_batch == nullptr) {
+      deadline_changed.wait(lock);
+      continue;
+    }
+
+    std::shared_ptr<Batch> batch = open_batch;
+    bool replaced = deadline_changed.wait_until(
+        lock, batch->deadline,
+        [&] { return stopping || open_batch != batch; });
+
+    if (!replaced) {
+      close(batch);
+    }
+  }
+}
+
+void GroupCommit::commit(std::vector<GroupCommitWrite> &writes) {
+  std::vector<BridgeResult> results;
+  results.reserve(writes.size());
+
+  try {
+    // A lone write does not need a transaction, and if one is already open
+    // (e.g. a transaction started from JS) the writes run as they are
+    bool in_transaction =
+        writes.size() > 1 &&
+        opsqlite_transaction_command(db_name, BeginImmediateCommand).type ==
+            SQLiteOk;
+
+    for (auto &write : writes) {
+      if (!in_transaction) {
+        results.push_back(opsqlite_execute(db_name, write.query,
+                                           &write.params, write.results.get(),
+                                           write.metadata));
+        continue;
+      }
+
+      opsqlite_transaction_command(db_name, SavepointCommand);
+
+      BridgeResult result =
+          opsqlite_execute(db_name, write.query, &write.params,
+                           write.results.get(), write.metadata);
+
+      // ON CONFLICT ROLLBACK and RAISE(ROLLBACK) end the whole transaction,
+      // the writes before this one are gone with it and the rest run alone
+      if (!opsqlite_in_transaction(db_name)) {
+        for (auto &write_result : results) {
+          if (write_result.type == SQLiteOk) {
+            write_result = {.type = SQLiteError,
+                            .message = "[op-sqlite] Rolled back by a later "
+                                       "write of the same group commit: " +
+                                       result.message};
+          }
+        }
+
+        results.push_back(std::move(result));
+        in_transaction = false;
+        continue;
+      }
+
+      if (result.type == SQLiteError) {
+        opsqlite_transaction_command(db_name, RollbackToCommand);
+      }
+
+      opsqlite_transaction_command(db_name, ReleaseCommand);
+
+      results.push_back(std::move(result));
+    }
+
+    if (in_transaction) {
+      BridgeResult result =
+          opsqlite_transaction_command(db_name, CommitCommand);
+
+      if (result.type == SQLiteError) {
+        opsqlite_transaction_command(db_name, RollbackCommand);
+
+        for (auto &write_result : results) {
+          if (write_result.type == SQLiteOk) {
+            write_result = result;
+          }
+        }
+      }
+    }
+  } catch (std::exception &exc) {
+    // The database was closed, fail every write that did not run
+    while (results.size() < writes.size()) {
+      results.push_back({.type = SQLiteError, .message = exc.what()});
+    }
+  }
+
+  for (size_t i = 0; i < writes.size(); i++) {
+    writes[i].callback(std::move(results[i]));
+  }
+}
+
+} // namespace opsqlite
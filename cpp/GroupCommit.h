@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ResultBuffer.h"
+#include "SmartHostObject.h"
+#include "ThreadPool.h"
+#include "types.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace opsqlite {
+
+/// An async write waiting to be committed together with others
+struct GroupCommitWrite {
+  std::string query;
+  std::vector<JSVariant> params;
+  std::shared_ptr<ResultBuffer> results;
+  std::shared_ptr<std::vector<SmartHostObject>> metadata;
+  // Called on the worker thread once the write has been committed or failed
+  std::function<void(BridgeResult)> callback;
+};
+
+/// Coalesces small async writes of a database into a single transaction.
+/// Writes that arrive within the window, or until max_writes is reached, are
+/// run inside one BEGIN IMMEDIATE/COMMIT on the database strand, so they pay
+/// for a single commit. Every write runs inside its own savepoint, a failing
+/// one is rolled back alone and the others still commit. The strand is held
+/// while the window is open, no worker waits for it to close
+class GroupCommit : public std::enable_shared_from_this<GroupCommit> {
+public:
+  GroupCommit(std::string db_name, std::shared_ptr<ThreadPool> thread_pool,
+              std::chrono::milliseconds window, size_t max_writes);
+  ~GroupCommit();
+
+  /// Only single INSERT, UPDATE, DELETE and REPLACE statements are coalesced
+  static bool can_coalesce(std::string const &query);
+
+  void add(GroupCommitWrite write);
+
+  /// Closes the batch being collected, called before queueing any other work
+  /// on the database strand so the queries keep their order
+  void seal();
+
+private:
+  struct Batch {
+    std::vector<GroupCommitWrite> writes;
+    std::chrono::steady_clock::time_point deadline;
+    bool closed = false;
+    // Set once the batch has its turn on the strand and holds it, the batch
+    // is flushed when it is also closed
+    bool held = false;
+    // Keeps the group commit alive until the batch is flushed
+    std::shared_ptr<GroupCommit> owner;
+  };
+
+  void hold(std::shared_ptr<Batch> const &batch);
+  // Called with mutex held
+  void close(std::shared_ptr<Batch> batch);
+  // Called with mutex held
+  void queue_flush(std::shared_ptr<Batch> const &batch);
+  void flush(std::shared_ptr<Batch> const &batch);
+  void commit(std::vector<GroupCommitWrite> &writes);
+  // Loop of the timer, closes the open batch at its deadline
+  void watch_deadlines();
+
+  std::string db_name;
+  std::shared_ptr<ThreadPool> thread_pool;
+  std::chrono::milliseconds window;
+  size_t max_writes;
+
+  std::mutex mutex;
+  std::condition_variable deadline_changed;
+  std::shared_ptr<Batch> open_batch;
+  // Started with the first batch
+  std::thread timer;
+  bool stopping = false;
+};
+
+} // namespace opsqlite
@@ -0,0 +1,52 @@
+#include "LazyRowsHostObject.h"
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+
+LazyRowsHostObject::LazyRowsHostObject(std::shared_ptr<ResultBuffer> buffer,
+                                       RowMode row_mode)
+    : buffer(std::move(buffer)), row_mode(row_mode) {
+  rows.resize(this->buffer->row_count());
+};
+
+std::vector<jsi::PropNameID>
+LazyRowsHostObject::getPropertyNames(jsi::Runtime &rt) {
+  std::vector<jsi::PropNameID> keys;
+  keys.push_back(jsi::PropNameID::forAscii(rt, "length"));
+  return keys;
+}
+
+jsi::Value LazyRowsHostObject::get(jsi::Runtime &rt,
+                                   const jsi::PropNameID &propNameID) {
+  auto name = propNameID.utf8(rt);
+
+  if (name == "length") {
+    return jsi::Value(static_cast<double>(rows.size()));
+  }
+
+  // Only canonical indexes, "01" is not a row
+  if (name.empty() || name.size() > 18 || (name.size() > 1 && name[0] == '0') ||
+      name.find_first_not_of("0123456789") != std::string::npos) {
+    return {};
+  }
+
+  size_t index = std::stoull(name);
+  if (index >= rows.size()) {
+    return {};
+  }
+
+  auto &cached = rows[index];
+  if (cached.has_value()) {
+    auto row = cached->lock(rt);
+    if (!row.isUndefined()) {
+      return row;
+    }
+  }
+
+  auto row = create_row(rt, buffer, index, row_mode).asObject(rt);
+  cached.emplace(rt, row);
+  return std::move(row);
+}
+
+} // namespace opsqlite
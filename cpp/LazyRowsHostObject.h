@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ResultBuffer.h"
+#include "utils.h"
+#include <jsi/jsi.h>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+
+/// The rows of a result set, created the first time their index is read. The
+/// rows are only weakly cached, a row the JS side has dropped is created again
+/// on the next read. Wrapped in an array Proxy on the JS side
+class JSI_EXPORT LazyRowsHostObject : public jsi::HostObject {
+public:
+  LazyRowsHostObject(std::shared_ptr<ResultBuffer> buffer, RowMode row_mode);
+
+  std::vector<jsi::PropNameID> getPropertyNames(jsi::Runtime &rt);
+
+  jsi::Value get(jsi::Runtime &rt, const jsi::PropNameID &propNameID);
+
+private:
+  std::shared_ptr<ResultBuffer> buffer;
+  RowMode row_mode;
+  std::vector<std::optional<jsi::WeakObject>> rows;
+};
+
+} // namespace opsqlite
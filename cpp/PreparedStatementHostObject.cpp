@@ -29,11 +29,12 @@ jsi::Value PreparedStatementHostObject::get(jsi::Runtime &rt,
       }
 
       const jsi::Value &js_params = args[0];
-      std::vector<JSVariant> params = to_variant_vec(rt, js_params);
+      // Binding copies the values, no need to copy the JS buffers before
+      std::vector<JSVariant> params = to_variant_vec(rt, js_params, true);
 #ifdef OP_SQLITE_USE_LIBSQL
       opsqlite_libsql_bind_statement(_stmt, &params);
 #else
-      opsqlite_bind_statement(_stmt, &params);
+      opsqlite_bind_statement(_name, _stmt, &params);
 #endif
 
       return {};
@@ -46,22 +47,22 @@ jsi::Value PreparedStatementHostObject::get(jsi::Runtime &rt,
         throw std::runtime_error("statement has been freed");
       }
 
-      std::vector<DumbHostObject> results;
+      auto results = std::make_shared<ResultBuffer>();
       std::shared_ptr<std::vector<SmartHostObject>> metadata =
           std::make_shared<std::vector<SmartHostObject>>();
 #ifdef OP_SQLITE_USE_LIBSQL
       auto status = opsqlite_libsql_execute_prepared_statement(
-          _name, _stmt, &results, metadata);
+          _name, _stmt, results.get(), metadata);
 #else
-      auto status =
-          opsqlite_execute_prepared_statement(_name, _stmt, &results, metadata);
+      auto status = opsqlite_execute_prepared_statement(
+          _name, _stmt, results.get(), metadata);
 #endif
 
       if (status.type == SQLiteError) {
         throw std::runtime_error(status.message);
       }
 
-      auto jsiResult = createResult(rt, status, &results, metadata);
+      auto jsiResult = createResult(rt, status, results, metadata);
       return jsiResult;
     });
   }
@@ -77,7 +78,7 @@ PreparedStatementHostObject::~PreparedStatementHostObject() {
   }
 #else
   if (_stmt != nullptr) {
-    sqlite3_finalize(_stmt);
+    opsqlite_finalize_statement(_name, _stmt);
     _stmt = nullptr;
   }
 #endif
@@ -0,0 +1,116 @@
+#include "ResultBuffer.h"
+#include "utils.h"
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+
+void ResultBuffer::set_column_names(std::vector<std::string> names) {
+  columns = std::make_shared<ColumnDictionary>(std::move(names));
+}
+
+size_t ResultBuffer::row_count() const {
+  if (column_count() == 0) {
+    return 0;
+  }
+  return cells.size() / column_count();
+}
+
+void ResultBuffer::reserve_rows(size_t rows) {
+  cells.reserve(rows * column_count());
+}
+
+void ResultBuffer::add_null() {
+  Cell cell;
+  cell.type = NullCell;
+  cell.entry = 0;
+  cells.push_back(cell);
+}
+
+void ResultBuffer::add_integer(int64_t value) {
+  Cell cell;
+  cell.type = IntegerCell;
+  cell.integer = value;
+  cells.push_back(cell);
+}
+
+void ResultBuffer::add_double(double value) {
+  Cell cell;
+  cell.type = DoubleCell;
+  cell.number = value;
+  cells.push_back(cell);
+}
+
+void ResultBuffer::add_text(const char *text, size_t size) {
+  Cell cell;
+  cell.type = TextCell;
+  cell.entry = offsets.size() - 1;
+  cells.push_back(cell);
+  add_bytes(text, size);
+}
+
+void ResultBuffer::add_blob(const void *blob, size_t size) {
+  Cell cell;
+  cell.type = BlobCell;
+  cell.entry = blobs.size();
+  cells.push_back(cell);
+  blobs.push_back(copy_array_buffer(blob, size));
+}
+
+void ResultBuffer::add_bytes(const void *data, size_t size) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  heap.insert(heap.end(), bytes, bytes + size);
+  offsets.push_back(heap.size());
+}
+
+const Cell &ResultBuffer::cell(size_t row, size_t column) const {
+  return cells[row * column_count() + column];
+}
+
+size_t ResultBuffer::memory() const {
+  size_t bytes = cells.capacity() * sizeof(Cell) +
+                 offsets.capacity() * sizeof(size_t) + heap.capacity();
+  for (auto const &blob : blobs) {
+    bytes += blob.size;
+  }
+  return bytes;
+}
+
+jsi::Value ResultBuffer::get_value(jsi::Runtime &rt, size_t row,
+                                   size_t column) const {
+  const Cell &c = cell(row, column);
+
+  switch (c.type) {
+  case IntegerCell:
+    if (big_ints && !is_safe_integer(c.integer)) {
+      return jsi::BigInt::fromInt64(rt, c.integer);
+    }
+    return jsi::Value(static_cast<double>(c.integer));
+
+  case DoubleCell:
+    return jsi::Value(c.number);
+
+  case TextCell: {
+    size_t start = offsets[c.entry];
+    return jsi::String::createFromUtf8(rt, heap.data() + start,
+                                       offsets[c.entry + 1] - start);
+  }
+
+  case BlobCell: {
+    const ArrayBuffer &blob = blobs[c.entry];
+    if (copy_blobs) {
+      ArrayBuffer copy = copy_array_buffer(blob.data.get(), blob.size);
+      return jsi::ArrayBuffer(
+          rt, std::make_shared<SharedBuffer>(copy.data, copy.size));
+    }
+    return jsi::ArrayBuffer(
+        rt, std::make_shared<SharedBuffer>(blob.data, blob.size));
+  }
+
+  case NullCell:
+  default:
+    return jsi::Value::null();
+  }
+}
+
+} // namespace opsqlite
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ColumnDictionary.h"
+#include "types.h"
+#include <jsi/jsi.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+
+enum CellType : uint8_t {
+  NullCell,
+  IntegerCell,
+  DoubleCell,
+  TextCell,
+  BlobCell
+};
+
+/// A fixed width slot, strings store the index of their entry in the offset
+/// table and blobs the index of their allocation instead of the data itself
+struct Cell {
+  CellType type;
+  union {
+    int64_t integer;
+    double number;
+    size_t entry;
+  };
+};
+
+/// Append-only storage for a whole result set. Cells are laid out row after
+/// row in a single vector and the bytes of every string are packed into one
+/// heap, so reading N rows costs a handful of allocations instead of several
+/// per row. Blobs get their own allocation which is later handed to JS as the
+/// backing store of the ArrayBuffer, without copying it again
+class ResultBuffer {
+public:
+  ResultBuffer(){};
+
+  /// Only called before the first row is added, every row has the shape of
+  /// the columns
+  void set_column_names(std::vector<std::string> names);
+  size_t column_count() const { return columns ? columns->size() : 0; }
+  size_t row_count() const;
+  void reserve_rows(size_t rows);
+
+  void add_null();
+  void add_integer(int64_t value);
+  void add_double(double value);
+  void add_text(const char *text, size_t size);
+  void add_blob(const void *blob, size_t size);
+
+  const Cell &cell(size_t row, size_t column) const;
+  /// Approximate bytes held by the rows
+  size_t memory() const;
+  jsi::Value get_value(jsi::Runtime &rt, size_t row, size_t column) const;
+
+  std::shared_ptr<ColumnDictionary> columns;
+  // Integers that do not fit in a double without losing precision are read as
+  // BigInt instead of a rounded number
+  bool big_ints = false;
+  // Set when the rows are handed to several callers, every ArrayBuffer then
+  // gets its own copy so writing to one does not change the rows of the others
+  bool copy_blobs = false;
+
+private:
+  void add_bytes(const void *data, size_t size);
+
+  std::vector<Cell> cells;
+  // offsets[i] is where entry i starts in the heap, the last element is the
+  // end of the heap so the size of an entry is offsets[i + 1] - offsets[i]
+  std::vector<size_t> offsets = {0};
+  std::vector<uint8_t> heap;
+  std::vector<ArrayBuffer> blobs;
+};
+
+} // namespace opsqlite
@@ -0,0 +1,196 @@
+#include "ResultCache.h"
+
+namespace opsqlite {
+
+void ResultCache::configure(ResultCacheOptions new_options,
+                            int64_t total_changes) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  drop_all();
+  options = new_options;
+  pending.clear();
+  changed_at.clear();
+  cleared_at = ++current_epoch;
+  settled_changes = total_changes;
+  reported_changes = 0;
+}
+
+bool ResultCache::enabled() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return options.max_entries > 0;
+}
+
+bool ResultCache::lookup(std::string const &key, CachedResult *result) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (options.max_entries == 0) {
+    return false;
+  }
+
+  auto it = index.find(key);
+  if (it == index.end()) {
+    misses++;
+    return false;
+  }
+
+  auto entry = it->second;
+  if (options.ttl.count() > 0 &&
+      std::chrono::steady_clock::now() >= entry->expires) {
+    erase(entry);
+    misses++;
+    return false;
+  }
+
+  hits++;
+  entries.splice(entries.begin(), entries, entry);
+  *result = entry->result;
+  return true;
+}
+
+uint64_t ResultCache::epoch() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return current_epoch;
+}
+
+void ResultCache::store(std::string const &key, CachedResult result,
+                        std::vector<std::string> tables, uint64_t started) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (options.max_entries == 0 || cleared_at > started) {
+    return;
+  }
+
+  // One of the tables was written since the query started, the rows may be
+  // from before the write
+  for (auto const &table : tables) {
+    if (pending.count(table) > 0) {
+      return;
+    }
+    auto changed = changed_at.find(table);
+    if (changed != changed_at.end() && changed->second > started) {
+      return;
+    }
+  }
+
+  size_t entry_memory = result.results->memory() + key.size();
+  if (entry_memory > options.max_memory) {
+    return;
+  }
+
+  auto existing = index.find(key);
+  if (existing != index.end()) {
+    erase(existing->second);
+  }
+
+  entries.push_front({key, std::move(result), std::move(tables), entry_memory,
+                      std::chrono::steady_clock::now() + options.ttl});
+  auto &entry = entries.front();
+  index[entry.key] = entries.begin();
+  for (auto const &table : entry.tables) {
+    dependents[table].insert(entry.key);
+  }
+  memory += entry_memory;
+
+  evict();
+}
+
+void ResultCache::table_changed(std::string const &table) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (options.max_entries == 0) {
+    return;
+  }
+
+  reported_changes++;
+  pending.insert(table);
+
+  auto it = dependents.find(table);
+  if (it == dependents.end()) {
+    return;
+  }
+
+  // Erasing an entry removes it from the set, so its keys are copied first
+  std::vector<std::string_view> keys(it->second.begin(), it->second.end());
+  for (auto key : keys) {
+    erase(index[key]);
+    invalidations++;
+  }
+}
+
+void ResultCache::settle(bool autocommit, int64_t total_changes) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (options.max_entries == 0 || !autocommit ||
+      (pending.empty() && total_changes == settled_changes)) {
+    return;
+  }
+
+  current_epoch++;
+
+  // Rows changed without the update hook hearing about them, there is no
+  // telling which tables they belong to
+  if (total_changes - settled_changes > reported_changes) {
+    invalidations += entries.size();
+    drop_all();
+    cleared_at = current_epoch;
+  }
+
+  for (auto const &table : pending) {
+    changed_at[table] = current_epoch;
+  }
+
+  pending.clear();
+  settled_changes = total_changes;
+  reported_changes = 0;
+}
+
+void ResultCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  drop_all();
+  cleared_at = ++current_epoch;
+}
+
+ResultCacheStats ResultCache::stats() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return {.hits = hits,
+          .misses = misses,
+          .invalidations = invalidations,
+          .evictions = evictions,
+          .size = entries.size(),
+          .memory = memory};
+}
+
+void ResultCache::erase(std::list<Entry>::iterator entry) {
+  for (auto const &table : entry->tables) {
+    auto it = dependents.find(table);
+    if (it != dependents.end()) {
+      it->second.erase(entry->key);
+      if (it->second.empty()) {
+        dependents.erase(it);
+      }
+    }
+  }
+
+  index.erase(entry->key);
+  memory -= entry->memory;
+  entries.erase(entry);
+}
+
+void ResultCache::drop_all() {
+  index.clear();
+  dependents.clear();
+  entries.clear();
+  memory = 0;
+}
+
+void ResultCache::evict() {
+  while (!entries.empty() && (entries.size() > options.max_entries ||
+                              memory > options.max_memory)) {
+    erase(std::prev(entries.end()));
+    evictions++;
+  }
+}
+
+} // namespace opsqlite
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ResultBuffer.h"
+#include "SmartHostObject.h"
+#include "types.h"
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace opsqlite {
+
+struct ResultCacheOptions {
+  // 0 turns the cache off
+  size_t max_entries = 0;
+  size_t max_memory = 4 * 1024 * 1024;
+  // Entries older than this are read again, 0 keeps them until one of their
+  // tables changes or they are evicted
+  std::chrono::milliseconds ttl{0};
+};
+
+struct ResultCacheStats {
+  size_t hits;
+  size_t misses;
+  size_t invalidations;
+  size_t evictions;
+  size_t size;
+  size_t memory;
+};
+
+struct CachedResult {
+  BridgeResult status;
+  std::shared_ptr<ResultBuffer> results;
+  std::shared_ptr<std::vector<SmartHostObject>> metadata;
+};
+
+/// LRU cache of the SELECT results of a database, keyed by query_key. Every
+/// entry knows the tables its query read, found by the authorizer while the
+/// query was prepared, and is dropped as soon as the update hook reports a
+/// change to one of them.
+///
+/// A table changed by a transaction stays pending until the main connection
+/// is back in autocommit mode, and a result read before that is never stored:
+/// the commit hook runs before readers can see the commit, so it is too early
+/// to let them fill the cache again. Writes the update hook does not report,
+/// to WITHOUT ROWID tables or a DELETE without WHERE, are noticed from the
+/// change counter of the connection and clear the whole cache
+class ResultCache {
+public:
+  /// Drops every entry. total_changes is the change counter of the main
+  /// connection at this point
+  void configure(ResultCacheOptions new_options, int64_t total_changes);
+  bool enabled();
+
+  /// Copies the entry of key into result, false on a miss
+  bool lookup(std::string const &key, CachedResult *result);
+
+  /// Taken before a query is run, and passed back to store with its result
+  uint64_t epoch();
+  void store(std::string const &key, CachedResult result,
+             std::vector<std::string> tables, uint64_t started);
+
+  /// Update hook, called for every row written on the main connection
+  void table_changed(std::string const &table);
+
+  /// Called after every call on the main connection
+  void settle(bool autocommit, int64_t total_changes);
+
+  /// Drops every entry, e.g. after a schema change
+  void clear();
+
+  ResultCacheStats stats();
+
+private:
+  struct Entry {
+    std::string key;
+    CachedResult result;
+    std::vector<std::string> tables;
+    size_t memory;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  void erase(std::list<Entry>::iterator entry);
+  void drop_all();
+  void evict();
+
+  std::mutex mutex;
+  ResultCacheOptions options;
+  // Most recently used entries live at the front
+  std::list<Entry> entries;
+  // Keys point to the key string stored in the list node
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+  // Keys of the entries that read each table
+  std::unordered_map<std::string, std::unordered_set<std::string_view>>
+      dependents;
+  size_t memory = 0;
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t invalidations = 0;
+  size_t evictions = 0;
+
+  // Bumped whenever changes are settled, a result read before the epoch at
+  // which one of its tables changed is not stored
+  uint64_t current_epoch = 0;
+  uint64_t cleared_at = 0;
+  std::unordered_map<std::string, uint64_t> changed_at;
+  // Changed by the transaction in progress
+  std::unordered_set<std::string> pending;
+  int64_t settled_changes = 0;
+  int64_t reported_changes = 0;
+};
+
+} // namespace opsqlite
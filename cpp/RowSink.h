@@ -0,0 +1,117 @@
+#pragma once
+
+#include "ResultBuffer.h"
+#include "types.h"
+#include "utils.h"
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace opsqlite {
+
+/// Sinks receive the rows stepped by the bridges. The step loops are
+/// templated on them, so every call below is resolved at compile time:
+///
+/// - decodes: false when the values of the rows are never read
+/// - needs_columns() and set_columns(names): column names, asked for once
+///   before the first row is decoded. execute_into also sets them before
+///   every statement whose columns differ from the previous one's, when
+///   can_reshape() says the rows read so far allow it
+/// - width(): how many columns of a row are decoded at most
+/// - add_null, add_integer, add_double, add_text, add_blob: the values of a
+///   row, left to right
+/// - end_row(decoded): called after every row with the number of values added
+/// - full(): stops stepping, the statement is left where it is
+///
+/// A sink of column-major buffers would fit the same interface, none exists
+/// since no result is consumed that way yet
+
+/// Rows read into a ResultBuffer, used for the results handed to JS as host
+/// objects. At most max_rows rows are read
+class ResultBufferSink {
+public:
+  static constexpr bool decodes = true;
+
+  explicit ResultBufferSink(
+      ResultBuffer *results,
+      size_t max_rows = std::numeric_limits<size_t>::max())
+      : results(results), max_rows(max_rows) {}
+
+  bool needs_columns() const { return results->column_count() == 0; }
+  // Every row has the columns of the buffer
+  bool can_reshape() const { return results->row_count() == 0; }
+  void set_columns(std::vector<std::string> names) {
+    results->set_column_names(std::move(names));
+  }
+  size_t width() const { return results->column_count(); }
+
+  void add_null() { results->add_null(); }
+  void add_integer(int64_t value) { results->add_integer(value); }
+  void add_double(double value) { results->add_double(value); }
+  void add_text(const char *text, size_t size) {
+    results->add_text(text, size);
+  }
+  void add_blob(const void *blob, size_t size) {
+    results->add_blob(blob, size);
+  }
+
+  void end_row(size_t decoded) { rows++; }
+
+  bool full() const { return rows >= max_rows; }
+
+private:
+  ResultBuffer *results;
+  size_t max_rows;
+  size_t rows = 0;
+};
+
+/// Rows read as arrays of variants, used by executeRaw
+class VariantRowsSink {
+public:
+  static constexpr bool decodes = true;
+
+  explicit VariantRowsSink(std::vector<std::vector<JSVariant>> *rows)
+      : rows(rows) {}
+
+  bool needs_columns() const { return false; }
+  // Every row has its own length
+  bool can_reshape() const { return true; }
+  void set_columns(std::vector<std::string> names) {}
+  size_t width() const { return std::numeric_limits<size_t>::max(); }
+
+  void add_null() { row.emplace_back(nullptr); }
+  void add_integer(int64_t value) {
+    row.emplace_back(static_cast<long long>(value));
+  }
+  void add_double(double value) { row.emplace_back(value); }
+  void add_text(const char *text, size_t size) {
+    row.emplace_back(std::string(text, size));
+  }
+  void add_blob(const void *blob, size_t size) {
+    row.emplace_back(copy_array_buffer(blob, size));
+  }
+
+  void end_row(size_t decoded) {
+    rows->push_back(std::move(row));
+    row = std::vector<JSVariant>();
+    row.reserve(decoded);
+  }
+
+  bool full() const { return false; }
+
+private:
+  std::vector<std::vector<JSVariant>> *rows;
+  std::vector<JSVariant> row;
+};
+
+/// Steps through the rows without reading them, for writes and for queries
+/// whose results are not wanted
+class DiscardSink {
+public:
+  static constexpr bool decodes = false;
+
+  void end_row(size_t decoded) {}
+  bool full() const { return false; }
+};
+
+} // namespace opsqlite
@@ -0,0 +1,36 @@
+#include "SingleFlight.h"
+
+namespace opsqlite {
+
+bool SingleFlight::join(std::string const &key, FlightCallback callback) {
+  auto it = flights.find(key);
+  if (it == flights.end()) {
+    return false;
+  }
+
+  it->second->followers.push_back(std::move(callback));
+  return true;
+}
+
+std::shared_ptr<SingleFlight::Flight>
+SingleFlight::start(std::string const &key) {
+  auto flight = std::make_shared<Flight>();
+  flights[key] = flight;
+  return flight;
+}
+
+std::vector<FlightCallback>
+SingleFlight::land(std::string const &key,
+                   std::shared_ptr<Flight> const &flight) {
+  // A sealed flight may have been replaced by a newer one with the same key
+  auto it = flights.find(key);
+  if (it != flights.end() && it->second == flight) {
+    flights.erase(it);
+  }
+
+  return std::move(flight->followers);
+}
+
+void SingleFlight::seal() { flights.clear(); }
+
+} // namespace opsqlite
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ResultBuffer.h"
+#include "SmartHostObject.h"
+#include "types.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace opsqlite {
+
+/// Settles one caller of a read with the shared result, on the JS thread
+using FlightCallback = std::function<void(
+    BridgeResult, std::shared_ptr<ResultBuffer>,
+    std::shared_ptr<std::vector<SmartHostObject>>)>;
+
+/// Identical async reads sent while the first one is still queued or running
+/// attach to it instead of running again, see is_single_select and
+/// query_key. The rows are read once into a ResultBuffer, every caller
+/// converts them to JS with its own options. Only used from the JS thread, so
+/// it needs no locking
+class SingleFlight {
+public:
+  struct Flight {
+    std::vector<FlightCallback> followers;
+  };
+
+  /// Attaches callback to the flight of key. False when there is none, the
+  /// caller then starts one and runs the query
+  bool join(std::string const &key, FlightCallback callback);
+
+  std::shared_ptr<Flight> start(std::string const &key);
+
+  /// Returns the callers that joined flight. Called once its result is in,
+  /// before settling anyone so a throwing callback cannot leave it open
+  std::vector<FlightCallback> land(std::string const &key,
+                                   std::shared_ptr<Flight> const &flight);
+
+  /// Reads sent from now on do not join the flights in progress, they might
+  /// miss a write sent in between. Called before anything else is sent to the
+  /// database
+  void seal();
+
+private:
+  std::unordered_map<std::string, std::shared_ptr<Flight>> flights;
+};
+
+} // namespace opsqlite
@@ -0,0 +1,85 @@
+#include "StatementCache.h"
+
+namespace opsqlite {
+
+StatementCache::StatementCache(size_t max_statements, size_t max_memory)
+    : max_statements(max_statements), max_memory(max_memory) {}
+
+StatementCache::~StatementCache() { clear(); }
+
+sqlite3_stmt *StatementCache::acquire(std::string const &sql) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto it = index.find(sql);
+  if (it == index.end()) {
+    misses++;
+    return nullptr;
+  }
+
+  hits++;
+  auto entry = it->second;
+  sqlite3_stmt *statement = entry->statement;
+  memory -= entry->memory;
+  index.erase(it);
+  entries.erase(entry);
+
+  return statement;
+}
+
+void StatementCache::release(std::string const &sql, sqlite3_stmt *statement) {
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Another thread prepared and released the same query while this copy was
+  // in use, keep only one of them
+  if (max_statements == 0 || index.count(sql) > 0) {
+    sqlite3_finalize(statement);
+    return;
+  }
+
+  size_t statement_memory = static_cast<size_t>(
+      sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_MEMUSED, 0));
+
+  entries.push_front({sql, statement, statement_memory});
+  index[entries.front().sql] = entries.begin();
+  memory += statement_memory;
+
+  evict();
+}
+
+void StatementCache::evict() {
+  while (!entries.empty() &&
+         (entries.size() > max_statements || memory > max_memory)) {
+    auto &oldest = entries.back();
+    index.erase(oldest.sql);
+    memory -= oldest.memory;
+    sqlite3_finalize(oldest.statement);
+    entries.pop_back();
+    evictions++;
+  }
+}
+
+void StatementCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  index.clear();
+  for (auto &entry : entries) {
+    sqlite3_finalize(entry.statement);
+  }
+  entries.clear();
+  memory = 0;
+}
+
+StatementCacheStats StatementCache::stats() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return {.hits = hits,
+          .misses = misses,
+          .evictions = evictions,
+          .size = entries.size(),
+          .memory = memory};
+}
+
+} // namespace opsqlite
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "sqlite3.h"
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Both limits can be overridden from the "sqliteFlags" config in package.json
+#ifndef OP_SQLITE_STATEMENT_CACHE_SIZE
+#define OP_SQLITE_STATEMENT_CACHE_SIZE 64
+#endif
+
+#ifndef OP_SQLITE_STATEMENT_CACHE_MEMORY
+#define OP_SQLITE_STATEMENT_CACHE_MEMORY (2 * 1024 * 1024)
+#endif
+
+namespace opsqlite {
+
+struct StatementCacheStats {
+  size_t hits;
+  size_t misses;
+  size_t evictions;
+  size_t size;
+  size_t memory;
+};
+
+/// LRU cache of prepared statements for a single connection, keyed by the SQL
+/// text. Statements are taken out of the cache while they are in use, so two
+/// threads never step the same sqlite3_stmt
+class StatementCache {
+public:
+  StatementCache(size_t max_statements = OP_SQLITE_STATEMENT_CACHE_SIZE,
+                 size_t max_memory = OP_SQLITE_STATEMENT_CACHE_MEMORY);
+  ~StatementCache();
+
+  /// Returns a ready to bind statement or nullptr on a cache miss
+  sqlite3_stmt *acquire(std::string const &sql);
+
+  /// Resets and unbinds the statement and puts it back as the most recently
+  /// used entry, evicting the oldest ones if the limits are exceeded
+  void release(std::string const &sql, sqlite3_stmt *statement);
+
+  /// Finalizes every idle statement, e.g. after a schema change
+  void clear();
+
+  StatementCacheStats stats();
+
+private:
+  struct Entry {
+    std::string sql;
+    sqlite3_stmt *statement;
+    size_t memory;
+  };
+
+  void evict();
+
+  std::mutex mutex;
+  // Most recently used entries live at the front
+  std::list<Entry> entries;
+  // Keys point to the sql string stored in the list node
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+  size_t max_statements;
+  size_t max_memory;
+  size_t memory = 0;
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+};
+
+} // namespace opsqlite
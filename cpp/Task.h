@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace opsqlite {
+
+/// Move-only callable queued on the thread pool. Unlike std::function it is
+/// never copied and callables of up to INLINE_SIZE bytes, such as the strand
+/// runners and most tasks of the host objects, are stored in place instead
+/// of on the heap
+class Task {
+public:
+  static constexpr size_t INLINE_SIZE = 64;
+
+  Task() noexcept = default;
+
+  template <typename F,
+            typename = std::enable_if_t<
+                !std::is_same<std::decay_t<F>, Task>::value>>
+  Task(F &&callable) {
+    using Callable = std::decay_t<F>;
+
+    if constexpr (fits_inline<Callable>()) {
+      new (&storage) Callable(std::forward<F>(callable));
+      vtable = &inline_vtable<Callable>;
+    } else {
+      new (&storage) Callable *(new Callable(std::forward<F>(callable)));
+      vtable = &heap_vtable<Callable>;
+    }
+  }
+
+  Task(Task &&other) noexcept : vtable(other.vtable) {
+    if (vtable != nullptr) {
+      vtable->move(&storage, &other.storage);
+      other.vtable = nullptr;
+    }
+  }
+
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      reset();
+      vtable = other.vtable;
+      if (vtable != nullptr) {
+        vtable->move(&storage, &other.storage);
+        other.vtable = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  Task(Task const &) = delete;
+  Task &operator=(Task const &) = delete;
+
+  ~Task() { reset(); }
+
+  explicit operator bool() const { return vtable != nullptr; }
+
+  void operator()() { vtable->call(&storage); }
+
+private:
+  struct VTable {
+    void (*call)(void *storage);
+    // Move constructs into dst and destroys what is left in src
+    void (*move)(void *dst, void *src);
+    void (*destroy)(void *storage);
+  };
+
+  template <typename Callable> static constexpr bool fits_inline() {
+    return sizeof(Callable) <= INLINE_SIZE &&
+           alignof(Callable) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible<Callable>::value;
+  }
+
+  template <typename Callable>
+  static constexpr VTable inline_vtable = {
+      [](void *storage) { (*static_cast<Callable *>(storage))(); },
+      [](void *dst, void *src) {
+        auto source = static_cast<Callable *>(src);
+        new (dst) Callable(std::move(*source));
+        source->~Callable();
+      },
+      [](void *storage) { static_cast<Callable *>(storage)->~Callable(); }};
+
+  template <typename Callable>
+  static constexpr VTable heap_vtable = {
+      [](void *storage) { (**static_cast<Callable **>(storage))(); },
+      [](void *dst, void *src) {
+        new (dst) Callable *(*static_cast<Callable **>(src));
+      },
+      [](void *storage) { delete *static_cast<Callable **>(storage); }};
+
+  void reset() {
+    if (vtable != nullptr) {
+      vtable->destroy(&storage);
+      vtable = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+  VTable const *vtable = nullptr;
+};
+
+} // namespace opsqlite
@@ -1,17 +1,101 @@
 #include "ThreadPool.h"
 
+#if defined(__APPLE__)
+#include <pthread/qos.h>
+#elif defined(__ANDROID__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
 namespace opsqlite {
 
-ThreadPool::ThreadPool() : done(false) {
-  // This returns the number of threads supported by the system. If the
-  // function can't figure out this information, it returns 0. 0 is not good,
-  // so we create at least 1
+/// Priority last applied to the calling worker, -1 before its first task
+thread_local int workerPriority = -1;
+
+/// Matches the scheduling priority of the calling worker to the lane of the
+/// task it is about to run. Only changed when the lane differs from the last
+/// one, so a worker staying on one lane does not pay for a syscall per task
+void applyThreadPriority(TaskPriority priority) {
+  if (workerPriority == priority) {
+    return;
+  }
+
+  workerPriority = priority;
+
+#if defined(__APPLE__)
+  qos_class_t qos = QOS_CLASS_DEFAULT;
+  if (priority == InteractivePriority) {
+    qos = QOS_CLASS_USER_INITIATED;
+  } else if (priority == BackgroundPriority) {
+    qos = QOS_CLASS_UTILITY;
+  }
+  pthread_set_qos_class_self_np(qos, 0);
+#elif defined(__ANDROID__)
+  // THREAD_PRIORITY_BACKGROUND and THREAD_PRIORITY_DEFAULT
+  setpriority(PRIO_PROCESS, gettid(), priority == BackgroundPriority ? 10 : 0);
+#endif
+}
+
+/// One worker per core, at least 1 when it cannot be told
+unsigned int defaultThreads() {
   auto numberOfThreads = std::thread::hardware_concurrency();
-  if (numberOfThreads == 0) {
-    numberOfThreads = 1;
+  return numberOfThreads > 0 ? numberOfThreads : 1;
+}
+
+ThreadPool::ThreadPool() : done(false) { configure(ThreadPoolOptions()); }
+
+void ThreadPool::configure(ThreadPoolOptions const &newOptions) {
+  stopWorkers();
+
+  std::lock_guard<std::mutex> g(workQueueMutex);
+  options = newOptions;
+  maxThreads =
+      options.max_threads > 0 ? options.max_threads : defaultThreads();
+
+  // A quarter of the workers, background tasks always get at least one
+  maxBackground = maxThreads / 4 > 0 ? maxThreads / 4 : 1;
+
+  startWorkers();
+}
+
+void ThreadPool::startWorkers() {
+  if (threads.size() >= maxThreads || idle > 0 || done) {
+    return;
+  }
+
+  // Lazily, the pool costs nothing until it is used
+  int lane = nextLane();
+  if (lane == -1) {
+    return;
   }
 
-  for (unsigned i = 0; i < numberOfThreads; ++i) {
+  unsigned int count = maxThreads - static_cast<unsigned int>(threads.size());
+
+  if (options.elastic) {
+    // The first worker starts right away, more only when the one before
+    // could not keep up
+    auto waited =
+        std::chrono::steady_clock::now() - workQueues[lane].front().queued;
+    if (!threads.empty() && waited < options.grow_after) {
+      if (!growerRunning) {
+        growerRunning = true;
+        if (grower.joinable()) {
+          exitedThreads.push_back(std::move(grower));
+        }
+        grower = std::thread(&ThreadPool::watchGrowth, this);
+      }
+      return;
+    }
+    count = 1;
+  }
+
+  // They have released the mutex for good, joining them is quick
+  for (auto &thread : exitedThreads) {
+    thread.join();
+  }
+  exitedThreads.clear();
+
+  for (unsigned i = 0; i < count; ++i) {
     // The threads will execute the private member `doWork`. Note that we need
     // to pass a reference to the function (namespaced with the class name) as
     // the first argument, and the current object as second argument
@@ -19,99 +103,306 @@ ThreadPool::ThreadPool() : done(false) {
   }
 }
 
-// The destructor joins all the threads so the program can exit gracefully.
-// This will be executed if there is any exception (e.g. creating the threads)
-ThreadPool::~ThreadPool() {
-  // So threads know it's time to shut down
-  done = true;
+void ThreadPool::watchGrowth() {
+  std::unique_lock<std::mutex> g(workQueueMutex);
+
+  while (!done) {
+    int lane = nextLane();
+    if (lane == -1 || idle > 0 || threads.size() >= maxThreads) {
+      break;
+    }
+
+    auto deadline = workQueues[lane].front().queued + options.grow_after;
+    // The new worker checks the tasks behind this one once it takes it
+    if (std::chrono::steady_clock::now() >= deadline) {
+      startWorkers();
+      break;
+    }
+
+    growerConditionVariable.wait_until(g, deadline);
+  }
+
+  growerRunning = false;
+}
+
+void ThreadPool::stopWorkers() {
+  std::vector<std::thread> stopping;
+
+  {
+    std::lock_guard<std::mutex> g(workQueueMutex);
+    // So threads know it's time to shut down
+    done = true;
+    stopping.swap(threads);
+    if (grower.joinable()) {
+      stopping.push_back(std::move(grower));
+    }
+    for (auto &thread : exitedThreads) {
+      stopping.push_back(std::move(thread));
+    }
+    exitedThreads.clear();
+  }
 
   // Wake up all the threads, so they can finish and be joined
   workQueueConditionVariable.notify_all();
+  growerConditionVariable.notify_all();
 
-  for (auto &thread : threads) {
+  for (auto &thread : stopping) {
     if (thread.joinable()) {
       thread.join();
     }
   }
 
-  threads.clear();
+  std::lock_guard<std::mutex> g(workQueueMutex);
+  done = false;
+}
+
+// The destructor joins all the threads so the program can exit gracefully.
+// This will be executed if there is any exception (e.g. creating the threads)
+ThreadPool::~ThreadPool() { stopWorkers(); }
+
+void ThreadPool::pushTask(Task task, TaskPriority priority) {
+  workQueues[priority].push(
+      {std::move(task), std::chrono::steady_clock::now()});
+
+  startWorkers();
+
+  // Notify one thread that there are requests to process
+  workQueueConditionVariable.notify_one();
 }
 
 // This function will be called by the server every time there is a request
 // that needs to be processed by the thread pool
-void ThreadPool::queueWork(std::function<void(void)> task) {
+void ThreadPool::queueWork(Task task, TaskPriority priority) {
   // Grab the mutex
   std::lock_guard<std::mutex> g(workQueueMutex);
 
   // Push the request to the queue
-  workQueue.push(task);
+  pushTask(std::move(task), priority);
+}
 
-  // Notify one thread that there are requests to process
-  workQueueConditionVariable.notify_one();
+void ThreadPool::queueWork(std::string const &strand, Task task,
+                           TaskPriority priority) {
+  std::lock_guard<std::mutex> g(workQueueMutex);
+
+  auto it = strands.find(strand);
+  if (it != strands.end()) {
+    // The strand already has a runner, it will pick up the task in order
+    it->second.push({std::move(task), priority});
+    return;
+  }
+
+  strands[strand].push({std::move(task), priority});
+  queueRunner(strand);
 }
 
-// Function used by the threads to grab work from the queue
-void ThreadPool::doWork() {
-  // Loop while the queue is not destructing
-  while (!done) {
-    std::function<void(void)> task;
+void ThreadPool::queueRunner(std::string const &strand) {
+  TaskPriority priority = strands[strand].front().priority;
+  pushTask([this, strand] { runStrand(strand); }, priority);
+}
+
+void ThreadPool::runStrand(std::string const &strand) {
+  std::unique_lock<std::mutex> g(workQueueMutex);
+
+  while (true) {
+    bool failed = false;
 
-    // Create a scope, so we don't lock the queue for longer than necessary
     {
-      std::unique_lock<std::mutex> g(workQueueMutex);
-      workQueueConditionVariable.wait(g, [&] {
-        // Only wake up if there are elements in the queue or the program is
-        // shutting down
-        return !workQueue.empty() || done;
-      });
-
-      // If we are shutting down exit witout trying to process more work
-      if (done) {
-        break;
+      auto &tasks = strands[strand];
+      Task task = std::move(tasks.front().work);
+      tasks.pop();
+
+      g.unlock();
+      // Tasks report their own errors, one escaping here must not leave the
+      // strand without a runner and hang every task queued behind it
+      try {
+        task();
+      } catch (...) {
+        failed = true;
       }
+    }
+
+    g.lock();
 
-      task = workQueue.front();
-      workQueue.pop();
+    // A task that failed cannot release the strand it held anymore
+    auto held = heldStrands.find(strand);
+    if (failed && held != heldStrands.end()) {
+      heldStrands.erase(held);
+      held = heldStrands.end();
     }
-    ++busy;
-    task();
-    --busy;
+
+    // The runner is restarted by releaseStrand
+    if (held != heldStrands.end()) {
+      held->second = true;
+      return;
+    }
+
+    auto it = strands.find(strand);
+    if (it->second.empty()) {
+      strands.erase(it);
+      return;
+    }
+
+    // Nothing else is waiting, the next task of the same lane runs right
+    // away instead of going through the queue and waking a worker for it.
+    // Not while the pool stops, the tasks are left for the next workers
+    if (!done && nextLane() == -1 &&
+        it->second.front().priority == workerPriority) {
+      continue;
+    }
+
+    // Back to the end of the line, other strands get a turn first
+    queueRunner(strand);
+    return;
   }
 }
 
-void ThreadPool::waitFinished() {
-  std::unique_lock<std::mutex> g(workQueueMutex);
-  workQueueConditionVariable.wait(
-      g, [&] { return workQueue.empty() && (busy == 0); });
+void ThreadPool::holdStrand(std::string const &strand) {
+  std::lock_guard<std::mutex> g(workQueueMutex);
+  heldStrands[strand] = false;
 }
 
-void ThreadPool::restartPool() {
-  // So threads know it's time to shut down
-  done = true;
+void ThreadPool::releaseStrand(std::string const &strand) {
+  std::lock_guard<std::mutex> g(workQueueMutex);
 
-  // Wake up all the threads, so they can finish and be joined
-  workQueueConditionVariable.notify_all();
+  auto held = heldStrands.find(strand);
+  if (held == heldStrands.end()) {
+    return;
+  }
 
-  for (auto &thread : threads) {
-    if (thread.joinable()) {
-      thread.join();
-    }
+  bool stopped = held->second;
+  heldStrands.erase(held);
+
+  // Still running the task that holds it, the runner carries on by itself
+  if (!stopped) {
+    return;
   }
 
-  threads.clear();
+  auto it = strands.find(strand);
+  if (it->second.empty()) {
+    strands.erase(it);
+    return;
+  }
 
-  auto numberOfThreads = std::thread::hardware_concurrency();
-  if (numberOfThreads == 0) {
-    numberOfThreads = 1;
+  queueRunner(strand);
+}
+
+bool ThreadPool::isStrandBusy(std::string const &strand) {
+  std::lock_guard<std::mutex> g(workQueueMutex);
+  return strands.count(strand) > 0;
+}
+
+int ThreadPool::nextLane() const {
+  for (int lane = 0; lane < TASK_PRIORITIES; lane++) {
+    if (workQueues[lane].empty()) {
+      continue;
+    }
+
+    if (lane == BackgroundPriority && backgroundBusy >= maxBackground) {
+      continue;
+    }
+
+    return lane;
   }
 
-  for (unsigned i = 0; i < numberOfThreads; ++i) {
-    // The threads will execute the private member `doWork`. Note that we need
-    // to pass a reference to the function (namespaced with the class name) as
-    // the first argument, and the current object as second argument
-    threads.push_back(std::thread(&ThreadPool::doWork, this));
+  return -1;
+}
+
+// Function used by the threads to grab work from the queue
+void ThreadPool::doWork() {
+  std::unique_lock<std::mutex> g(workQueueMutex);
+
+  // Loop while the queue is not destructing
+  while (!done) {
+    // Only wake up if there is work this thread may take or the program is
+    // shutting down
+    auto ready = [&] { return nextLane() != -1 || done; };
+
+    idle++;
+    bool woken = true;
+    if (options.elastic) {
+      woken = workQueueConditionVariable.wait_for(g, options.idle_timeout,
+                                                  ready);
+    } else {
+      workQueueConditionVariable.wait(g, ready);
+    }
+    idle--;
+
+    // If we are shutting down exit witout trying to process more work
+    if (done) {
+      break;
+    }
+
+    // Idle for too long, an elastic pool gives the thread back
+    if (!woken) {
+      auto self = std::this_thread::get_id();
+      for (auto it = threads.begin(); it != threads.end(); it++) {
+        if (it->get_id() == self) {
+          exitedThreads.push_back(std::move(*it));
+          threads.erase(it);
+          break;
+        }
+      }
+      return;
+    }
+
+    auto priority = static_cast<TaskPriority>(nextLane());
+    Task task = std::move(workQueues[priority].front().work);
+    workQueues[priority].pop();
+
+    ++busy;
+    if (priority == BackgroundPriority) {
+      ++backgroundBusy;
+    }
+
+    // The tasks behind this one may have waited long enough for another
+    // worker
+    startWorkers();
+
+    g.unlock();
+
+    applyThreadPriority(priority);
+    // The worker and its counters outlive a task that throws
+    try {
+      task();
+    } catch (...) {
+    }
+    // Captures are released before the lock is taken again
+    task = Task();
+
+    g.lock();
+
+    --busy;
+    if (priority == BackgroundPriority) {
+      --backgroundBusy;
+    }
+
+    // A background task may be waiting for this share of the workers, and
+    // waitFinished for the pool to go idle
+    if ((priority == BackgroundPriority &&
+         !workQueues[BackgroundPriority].empty()) ||
+        busy == 0) {
+      workQueueConditionVariable.notify_all();
+    }
   }
+}
 
-  done = false;
+void ThreadPool::waitFinished() {
+  std::unique_lock<std::mutex> g(workQueueMutex);
+  workQueueConditionVariable.wait(g, [&] {
+    for (auto &workQueue : workQueues) {
+      if (!workQueue.empty()) {
+        return false;
+      }
+    }
+    return busy == 0;
+  });
+}
+
+void ThreadPool::restartPool() {
+  stopWorkers();
+
+  // Tasks queued in the meantime still have to run
+  std::lock_guard<std::mutex> g(workQueueMutex);
+  startWorkers();
 }
 } // namespace opsqlite
@@ -1,26 +1,86 @@
 #ifndef ThreadPool_h
 #define ThreadPool_h
 
+#include "Task.h"
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <exception>
+#include <functional>
 #include <mutex>
 #include <queue>
 #include <stdio.h>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace opsqlite {
 
+// Lanes of the pool. Workers take the most urgent task there is, background
+// tasks only run on a share of the workers and at a lower thread priority so
+// bulk work does not hold up what the user waits for
+enum TaskPriority { InteractivePriority, NormalPriority, BackgroundPriority };
+
+const int TASK_PRIORITIES = 3;
+
+struct ThreadPoolOptions {
+  // Most workers the pool runs, 0 for one per core
+  unsigned int max_threads = 0;
+  // Workers are started one at a time, when queued work has waited longer
+  // than grow_after, and stop after being idle for idle_timeout. Otherwise
+  // every worker is started with the first task and kept
+  bool elastic = false;
+  std::chrono::milliseconds grow_after{5};
+  std::chrono::milliseconds idle_timeout{10000};
+};
+
 class ThreadPool {
 public:
+  // No thread is started until work is queued
   ThreadPool();
   ~ThreadPool();
-  void queueWork(std::function<void(void)> task);
+  // Workers that are running are stopped, the new sizing applies from the
+  // next task on
+  void configure(ThreadPoolOptions const &options);
+  void queueWork(Task task, TaskPriority priority = NormalPriority);
+  // Tasks queued on the same strand run one at a time and in order, used to
+  // serialize the work of a database connection. The strand runs at the
+  // priority of its next task
+  void queueWork(std::string const &strand, Task task,
+                 TaskPriority priority = NormalPriority);
+  // Called from a task of the strand, the tasks queued after it wait until
+  // releaseStrand so the holder has the connection to itself
+  void holdStrand(std::string const &strand);
+  void releaseStrand(std::string const &strand);
+  // Whether the strand has tasks queued or running, or is held
+  bool isStrandBusy(std::string const &strand);
   void waitFinished();
+  // Stops the workers once their current task is done, tasks still queued
+  // are kept and run by new workers
   void restartPool();
 
 private:
-  unsigned int busy;
+  struct StrandTask {
+    Task work;
+    TaskPriority priority;
+  };
+
+  struct QueuedTask {
+    Task work;
+    std::chrono::steady_clock::time_point queued;
+  };
+
+  ThreadPoolOptions options;
+  unsigned int maxThreads = 1;
+
+  unsigned int busy = 0;
+  // Workers waiting for a task
+  unsigned int idle = 0;
+
+  // Workers running background tasks, at most maxBackground at a time
+  unsigned int backgroundBusy = 0;
+  unsigned int maxBackground = 1;
   // This condition variable is used for the threads to wait until there is work
   // to do
   std::condition_variable_any workQueueConditionVariable;
@@ -28,18 +88,63 @@ private:
   // We store the threads in a vector, so we can later stop them gracefully
   std::vector<std::thread> threads;
 
+  // Workers that stopped after idle_timeout, joined when the next one starts
+  std::vector<std::thread> exitedThreads;
+
+  // Elastic pools only. Runs while queued work waits for grow_after to pass
+  // with every worker busy, nothing else would look at the queue again until
+  // a task is pushed or finishes
+  std::thread grower;
+  bool growerRunning = false;
+  std::condition_variable_any growerConditionVariable;
+
   // Mutex to protect workQueue
   std::mutex workQueueMutex;
 
-  // Queue of requests waiting to be processed
-  std::queue<std::function<void(void)>> workQueue;
+  // Queues of requests waiting to be processed, one per TaskPriority
+  std::queue<QueuedTask> workQueues[TASK_PRIORITIES];
+
+  // Pending tasks of every strand. A strand is in the map only while it has a
+  // runner in the work queue or being executed, the runner takes one task at a
+  // time and goes back to the end of the work queue, so busy strands take
+  // turns instead of starving each other
+  std::unordered_map<std::string, std::queue<StrandTask>> strands;
+
+  // Held strands, mapped to whether their runner has stopped after the task
+  // holding them. They stay in the strands map so new tasks are only queued
+  std::unordered_map<std::string, bool> heldStrands;
 
   // This will be set to true when the thread pool is shutting down. This tells
   // the threads to stop looping and finish
-  bool done;
+  std::atomic<bool> done;
 
   // Function used by the threads to grab work from the queue
   void doWork();
+
+  // Starts workers for the queued tasks, all of them or in elastic mode one
+  // when the oldest task has waited too long. Called with workQueueMutex held
+  void startWorkers();
+
+  // Stops and joins every worker
+  void stopWorkers();
+
+  // Loop of the grower, starts a worker once the oldest task has waited
+  // grow_after
+  void watchGrowth();
+
+  // Called with workQueueMutex held
+  void pushTask(Task task, TaskPriority priority);
+
+  // Lane the next task should come from, -1 when nothing can run. Called with
+  // workQueueMutex held
+  int nextLane() const;
+
+  // Runs the next task of a strand
+  void runStrand(std::string const &strand);
+
+  // Queues the runner of a strand in the lane of its next task. Called with
+  // workQueueMutex held
+  void queueRunner(std::string const &strand);
 };
 
 } // namespace opsqlite
@@ -0,0 +1,361 @@
+#include "TransactionHostObject.h"
+#include "macros.h"
+#include "utils.h"
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+namespace react = facebook::react;
+
+std::atomic<int> TransactionHostObject::next_id{0};
+
+TransactionHostObject::TransactionHostObject(
+    jsi::Runtime &rt, std::string db_name,
+    std::shared_ptr<react::CallInvoker> js_call_invoker,
+    std::shared_ptr<ThreadPool> thread_pool)
+    : rt(rt), db_name(std::move(db_name)),
+      js_call_invoker(std::move(js_call_invoker)),
+      thread_pool(std::move(thread_pool)) {
+  strand = this->db_name + "#transaction" + std::to_string(next_id++);
+};
+
+void TransactionHostObject::begin(std::function<void(BridgeResult)> callback) {
+  auto self = shared_from_this();
+
+  thread_pool->queueWork(db_name, [self, callback] {
+    BridgeResult result;
+
+    try {
+      result = opsqlite_transaction_command(self->db_name, BeginCommand);
+    } catch (std::exception &exc) {
+      result = {.type = SQLiteError, .message = exc.what()};
+    }
+
+    if (result.type == SQLiteOk) {
+      self->thread_pool->holdStrand(self->db_name);
+      self->started = true;
+    }
+
+    callback(std::move(result));
+  });
+}
+
+bool TransactionHostObject::is_open() const { return started && !finalized; }
+
+std::string const &TransactionHostObject::get_strand() const { return strand; }
+
+void TransactionHostObject::abandon() {
+  if (is_open()) {
+    finalize(RollbackCommand, nullptr);
+  }
+}
+
+std::vector<jsi::PropNameID>
+TransactionHostObject::getPropertyNames(jsi::Runtime &rt) {
+  std::vector<jsi::PropNameID> keys;
+
+  return keys;
+}
+
+jsi::Value TransactionHostObject::get(jsi::Runtime &rt,
+                                      const jsi::PropNameID &propNameID) {
+  auto name = propNameID.utf8(rt);
+
+  if (name == "execute") {
+    return HOSTFN("execute", 3) {
+      check_not_finalized();
+
+      // Would run on the connection at the same time as them
+      if (pending > 0) {
+        throw std::runtime_error(
+            "[op-sqlite][execute] Async statements of the transaction are "
+            "still running, await them or use executeAsync");
+      }
+
+      const std::string query = args[0].asString(rt).utf8(rt);
+      std::vector<JSVariant> params;
+
+      if (count >= 2) {
+        params = to_variant_vec(rt, args[1], true);
+      }
+
+      ExecuteOptions execute_options =
+          count == 3 ? to_execute_options(rt, args[2]) : ExecuteOptions();
+
+      // Same as db.execute
+      if (execute_options.cancellation != nullptr &&
+          !opsqlite_is_owned_connection(db_name)) {
+        throw std::runtime_error(
+            "[op-sqlite][execute] signal and timeoutMs need a database opened "
+            "with ownedConnection, use executeAsync instead");
+      }
+
+      auto results = std::make_shared<ResultBuffer>();
+      auto metadata = std::make_shared<std::vector<SmartHostObject>>();
+
+      auto status =
+          opsqlite_execute(db_name, query, &params, results.get(), metadata,
+                           execute_options.cancellation.get());
+
+      if (status.type == SQLiteError) {
+        throw std::runtime_error(status.message);
+      }
+
+      return createResult(rt, status, results, metadata, execute_options);
+    });
+  }
+
+  if (name == "executeAsync") {
+    return HOSTFN("executeAsync", 3) {
+      check_not_finalized();
+
+      const std::string query = args[0].asString(rt).utf8(rt);
+      std::vector<JSVariant> params;
+
+      if (count >= 2) {
+        params = to_variant_vec(rt, args[1]);
+      }
+
+      ExecuteOptions execute_options =
+          count == 3 ? to_execute_options(rt, args[2]) : ExecuteOptions();
+
+      auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+      auto promise = promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+        auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+        auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+        auto self = shared_from_this();
+
+        auto task = [self, query, params, resolve, reject, execute_options]() {
+          auto results = std::make_shared<ResultBuffer>();
+          auto metadata = std::make_shared<std::vector<SmartHostObject>>();
+          BridgeResult status;
+
+          // Commit and rollback are queued behind it, it still runs inside
+          // the transaction
+          try {
+            status = opsqlite_execute(self->db_name, query, &params,
+                                      results.get(), metadata,
+                                      execute_options.cancellation.get());
+          } catch (std::exception &exc) {
+            status = {.type = SQLiteError, .message = exc.what()};
+          }
+
+          self->pending--;
+
+          self->js_call_invoker->invokeAsync([self, results, metadata,
+                                              status = std::move(status),
+                                              resolve, reject,
+                                              execute_options] {
+            auto &rt = self->rt;
+
+            if (status.type == SQLiteOk) {
+              auto jsiResult =
+                  createResult(rt, status, results, metadata, execute_options);
+              resolve->asObject(rt).asFunction(rt).call(rt,
+                                                        std::move(jsiResult));
+            } else {
+              auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+              auto error = errorCtr.callAsConstructor(
+                  rt, jsi::String::createFromUtf8(rt, status.message));
+              reject->asObject(rt).asFunction(rt).call(rt, error);
+            }
+          });
+        };
+
+        pending++;
+        thread_pool->queueWork(strand, std::move(task));
+
+        return {};
+      }));
+
+      return promise;
+    });
+  }
+
+  if (name == "commit" || name == "rollback") {
+    auto command = name == "commit" ? CommitCommand : RollbackCommand;
+
+    return HOSTFN(name.c_str(), 0) {
+      check_not_finalized();
+
+      return command_promise(rt, [this, command](auto settle) {
+        finalize(command, std::move(settle));
+      });
+    });
+  }
+
+  if (name == "savepoint") {
+    return HOSTFN("savepoint", 0) {
+      check_not_finalized();
+
+      return command_promise(rt, [this](auto settle) {
+        auto self = shared_from_this();
+
+        pending++;
+        thread_pool->queueWork(strand, [self, settle] {
+          BridgeResult result = self->run_savepoint_command(SavepointCommand);
+          self->pending--;
+          settle(std::move(result));
+        });
+      });
+    });
+  }
+
+  if (name == "releaseSavepoint" || name == "rollbackSavepoint") {
+    auto command =
+        name == "rollbackSavepoint" ? RollbackToCommand : ReleaseCommand;
+
+    return HOSTFN(name.c_str(), 0) {
+      check_not_finalized();
+
+      return command_promise(rt, [this, command](auto settle) {
+        auto self = shared_from_this();
+
+        pending++;
+        thread_pool->queueWork(strand, [self, command, settle] {
+          BridgeResult result = self->run_savepoint_command(command);
+          self->pending--;
+          settle(std::move(result));
+        });
+      });
+    });
+  }
+
+  if (name == "finalized") {
+    return jsi::Value(finalized.load());
+  }
+
+  return {};
+}
+
+/// Promise settled on the JS thread with the result start hands to the
+/// callback it is given, which may be called from any thread
+jsi::Value TransactionHostObject::command_promise(
+    jsi::Runtime &rt,
+    std::function<void(std::function<void(BridgeResult)>)> start) {
+  auto promiseCtr = rt.global().getPropertyAsFunction(rt, "Promise");
+  return promiseCtr.callAsConstructor(rt, HOSTFN("executor", 2) {
+    auto resolve = std::make_shared<jsi::Value>(rt, args[0]);
+    auto reject = std::make_shared<jsi::Value>(rt, args[1]);
+    auto self = shared_from_this();
+
+    start([self, resolve, reject](BridgeResult status) {
+      self->js_call_invoker->invokeAsync([self, status = std::move(status),
+                                          resolve, reject] {
+        auto &rt = self->rt;
+
+        if (status.type == SQLiteOk) {
+          auto jsiResult =
+              createResult(rt, status, std::make_shared<ResultBuffer>(),
+                           std::make_shared<std::vector<SmartHostObject>>());
+          resolve->asObject(rt).asFunction(rt).call(rt, std::move(jsiResult));
+        } else {
+          auto errorCtr = rt.global().getPropertyAsFunction(rt, "Error");
+          auto error = errorCtr.callAsConstructor(
+              rt, jsi::String::createFromUtf8(rt, status.message));
+          reject->asObject(rt).asFunction(rt).call(rt, error);
+        }
+      });
+    });
+
+    return {};
+  }));
+}
+
+/// Runs on the strand of the transaction, which is the only place the depth
+/// of the savepoints is touched
+BridgeResult
+TransactionHostObject::run_savepoint_command(TransactionCommand command) {
+  try {
+    if (command == SavepointCommand) {
+      BridgeResult result =
+          opsqlite_transaction_command(db_name, command, savepoints + 1);
+      if (result.type == SQLiteOk) {
+        savepoints++;
+      }
+      return result;
+    }
+
+    if (savepoints == 0) {
+      return {.type = SQLiteError,
+              .message = "[op-sqlite] No savepoint is open"};
+    }
+
+    BridgeResult result = {.type = SQLiteOk};
+
+    // ROLLBACK TO leaves the savepoint open, it is released afterwards
+    if (command == RollbackToCommand) {
+      result = opsqlite_transaction_command(db_name, command, savepoints);
+    }
+
+    if (result.type == SQLiteOk) {
+      result = opsqlite_transaction_command(db_name, ReleaseCommand, savepoints);
+    }
+
+    savepoints--;
+    return result;
+  } catch (std::exception &exc) {
+    return {.type = SQLiteError, .message = exc.what()};
+  }
+}
+
+void TransactionHostObject::check_not_finalized() {
+  if (finalized) {
+    throw std::runtime_error(
+        "[op-sqlite] Cannot execute query on finalized transaction");
+  }
+}
+
+/// Queues COMMIT or ROLLBACK behind the statements of the transaction, then
+/// gives the connection back to the database strand. Takes no reference to
+/// the transaction, it also runs for one being destroyed. The callback, if
+/// any, runs on the worker with the result
+void TransactionHostObject::finalize(
+    TransactionCommand command, std::function<void(BridgeResult)> callback) {
+  finalized = true;
+
+  ThreadPool *pool = thread_pool.get();
+  thread_pool->queueWork(strand, [pool, db_name = db_name, command, callback] {
+    BridgeResult result;
+
+    try {
+      result = opsqlite_transaction_command(db_name, command);
+
+      // A failed commit can leave the transaction open
+      if (result.type == SQLiteError && command == CommitCommand) {
+        opsqlite_transaction_command(db_name, RollbackCommand);
+      }
+    } catch (std::exception &exc) {
+      result = {.type = SQLiteError, .message = exc.what()};
+    }
+
+    pool->releaseStrand(db_name);
+
+    if (callback) {
+      callback(std::move(result));
+    }
+  });
+}
+
+bool TransactionSlot::is_open() const {
+  auto open = transaction.lock();
+  return open != nullptr && open->is_open();
+}
+
+std::string TransactionSlot::strand(std::string const &db_name) const {
+  auto open = transaction.lock();
+  if (open != nullptr && open->is_open()) {
+    return open->get_strand();
+  }
+
+  return db_name;
+}
+
+TransactionHostObject::~TransactionHostObject() {
+  // Abandoned without commit or rollback
+  if (started && !finalized) {
+    finalize(RollbackCommand, nullptr);
+  }
+}
+
+} // namespace opsqlite
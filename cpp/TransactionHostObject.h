@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include "bridge.h"
+#include <ReactCommon/CallInvoker.h>
+#include <atomic>
+#include <functional>
+#include <jsi/jsi.h>
+#include <memory>
+#include <string>
+
+namespace opsqlite {
+
+namespace jsi = facebook::jsi;
+namespace react = facebook::react;
+
+/// An open transaction. While it is alive the strand of the database is held,
+/// so no other queued work touches the connection until commit or rollback.
+/// Its async statements, savepoints, then COMMIT or ROLLBACK, run in order on
+/// a strand of their own
+class JSI_EXPORT TransactionHostObject
+    : public jsi::HostObject,
+      public std::enable_shared_from_this<TransactionHostObject> {
+public:
+  TransactionHostObject(jsi::Runtime &rt, std::string db_name,
+                        std::shared_ptr<react::CallInvoker> js_call_invoker,
+                        std::shared_ptr<ThreadPool> thread_pool);
+  virtual ~TransactionHostObject();
+
+  /// Queues BEGIN on the database strand and holds it once the transaction
+  /// has started, the callback runs on the worker with the result
+  void begin(std::function<void(BridgeResult)> callback);
+
+  /// Started and not yet committed or rolled back
+  bool is_open() const;
+
+  std::string const &get_strand() const;
+
+  /// Rolls back the transaction if it is still open and gives the database
+  /// strand back, without waiting for it to be garbage collected
+  void abandon();
+
+  std::vector<jsi::PropNameID> getPropertyNames(jsi::Runtime &rt);
+
+  jsi::Value get(jsi::Runtime &rt, const jsi::PropNameID &propNameID);
+
+private:
+  void check_not_finalized();
+  void finalize(TransactionCommand command,
+                std::function<void(BridgeResult)> callback);
+  jsi::Value
+  command_promise(jsi::Runtime &rt,
+                  std::function<void(std::function<void(BridgeResult)>)> start);
+  BridgeResult run_savepoint_command(TransactionCommand command);
+
+  jsi::Runtime &rt;
+  std::string db_name;
+  // Strand of the statements of this transaction, distinct from the held
+  // database strand
+  std::string strand;
+  std::shared_ptr<react::CallInvoker> js_call_invoker;
+  std::shared_ptr<ThreadPool> thread_pool;
+
+  // Depth of the innermost open savepoint, 0 when there is none. Only used
+  // on the strand of the transaction
+  int savepoints = 0;
+  // Async statements and savepoints queued and not done yet, counted down
+  // before their promise settles
+  std::atomic<int> pending{0};
+  std::atomic<bool> started{false};
+  std::atomic<bool> finalized{false};
+
+  static std::atomic<int> next_id;
+};
+
+/// The native transaction open on a database, shared by the objects that
+/// queue work on it. Only used on the JS thread
+struct TransactionSlot {
+  std::weak_ptr<TransactionHostObject> transaction;
+
+  /// Whether a transaction holds the database strand
+  bool is_open() const;
+
+  /// Strand the work of the database is queued on. While a transaction holds
+  /// the database strand that is the strand of the transaction, work awaited
+  /// inside it would otherwise wait for it to end
+  std::string strand(std::string const &db_name) const;
+};
+
+} // namespace opsqlite
@@ -68,6 +68,18 @@ void install(jsi::Runtime &rt, std::shared_ptr<react::CallInvoker> invoker,
           options.getProperty(rt, "encryptionKey").asString(rt).utf8(rt);
     }
 
+    int readerConnections = 0;
+    if (options.hasProperty(rt, "readerConnections")) {
+      readerConnections = static_cast<int>(
+          options.getProperty(rt, "readerConnections").asNumber());
+    }
+
+    bool ownedConnection = false;
+    if (options.hasProperty(rt, "ownedConnection")) {
+      auto owned = options.getProperty(rt, "ownedConnection");
+      ownedConnection = owned.isBool() && owned.getBool();
+    }
+
 #ifdef OP_SQLITE_USE_SQLCIPHER
     if (encryptionKey.empty()) {
       throw std::runtime_error(
@@ -87,7 +99,7 @@ void install(jsi::Runtime &rt, std::shared_ptr<react::CallInvoker> invoker,
 
     std::shared_ptr<DBHostObject> db = std::make_shared<DBHostObject>(
         rt, path, invoker, thread_pool, name, path, _crsqlite_path,
-        _sqlite_vec_path, encryptionKey);
+        _sqlite_vec_path, encryptionKey, readerConnections, ownedConnection);
     return jsi::Object::createFromHostObject(rt, db);
   });
 
@@ -150,8 +162,42 @@ void install(jsi::Runtime &rt, std::shared_ptr<react::CallInvoker> invoker,
   });
 #endif
 
+  auto configure_thread_pool = HOSTFN("configureThreadPool", 1) {
+    ThreadPoolOptions options;
+
+    if (count > 0 && args[0].isObject()) {
+      auto options_obj = args[0].asObject(rt);
+
+      auto max_threads = options_obj.getProperty(rt, "maxThreads");
+      if (max_threads.isNumber() && max_threads.asNumber() >= 1) {
+        options.max_threads = static_cast<unsigned int>(max_threads.asNumber());
+      }
+
+      auto elastic = options_obj.getProperty(rt, "elastic");
+      options.elastic = elastic.isBool() && elastic.getBool();
+
+      auto grow_after = options_obj.getProperty(rt, "growAfterMs");
+      if (grow_after.isNumber() && grow_after.asNumber() >= 0) {
+        options.grow_after = std::chrono::milliseconds(
+            static_cast<long long>(grow_after.asNumber()));
+      }
+
+      auto idle_timeout = options_obj.getProperty(rt, "idleTimeoutMs");
+      if (idle_timeout.isNumber() && idle_timeout.asNumber() > 0) {
+        options.idle_timeout = std::chrono::milliseconds(
+            static_cast<long long>(idle_timeout.asNumber()));
+      }
+    }
+
+    thread_pool->configure(options);
+
+    return {};
+  });
+
   jsi::Object module = jsi::Object(rt);
   module.setProperty(rt, "open", std::move(open));
+  module.setProperty(rt, "configureThreadPool",
+                     std::move(configure_thread_pool));
   module.setProperty(rt, "isSQLCipher", std::move(is_sqlcipher));
   module.setProperty(rt, "isLibsql", std::move(is_libsql));
 #ifdef OP_SQLITE_USE_LIBSQL
@@ -1,9 +1,18 @@
 #include "bridge.h"
-#include "DumbHostObject.h"
+#include "DecodePlan.h"
+#include "ResultBuffer.h"
+#include "ResultCache.h"
+#include "RowSink.h"
 #include "SmartHostObject.h"
+#include "StatementCache.h"
 #include "logs.h"
 #include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <strings.h>
 #include <unordered_map>
 #include <variant>
 
@@ -22,12 +31,488 @@ std::unordered_map<std::string, CommitCallback> commitCallbackMap =
 std::unordered_map<std::string, RollbackCallback> rollbackCallbackMap =
     std::unordered_map<std::string, RollbackCallback>();
 
+/// Guards the maps of per-connection state below. They are filled and
+/// emptied on the JS thread while the workers look them up, it is only held
+/// for that and never while calling into SQLite
+std::mutex connectionMapsMutex;
+
+/// Statement caches are per connection, so they are keyed by the handle
+std::unordered_map<sqlite3 *, std::shared_ptr<StatementCache>>
+    statementCacheMap =
+        std::unordered_map<sqlite3 *, std::shared_ptr<StatementCache>>();
+
+/// Result caches are only kept for the main connections, the readers never
+/// write so they need no hooks
+std::unordered_map<sqlite3 *, std::shared_ptr<ResultCache>> resultCacheMap =
+    std::unordered_map<sqlite3 *, std::shared_ptr<ResultCache>>();
+
+/// Read-only connections of a database, each one is used by a single thread
+/// at a time
+struct ReaderPool {
+  std::vector<sqlite3 *> connections;
+  std::vector<sqlite3 *> idle;
+  std::mutex mutex;
+  std::condition_variable available;
+  bool closed = false;
+  // Whether the main connection was in autocommit mode after its last call,
+  // so the JS thread can tell without touching a connection in use
+  std::atomic<bool> main_autocommit{true};
+};
+
+std::unordered_map<std::string, std::shared_ptr<ReaderPool>> readerPoolMap =
+    std::unordered_map<std::string, std::shared_ptr<ReaderPool>>();
+
+/// Set by the authorizer while a statement is being prepared on this thread
+thread_local bool statementChangesSchema = false;
+
+/// Tables read by the statements prepared on this thread, collected by the
+/// authorizer when set
+thread_local std::vector<std::string> *statementReadTables = nullptr;
+
+/// How a statement has to be disposed of once it has been stepped
+enum StatementOrigin { Uncached, Cacheable, SchemaChange };
+
 inline void check_db_open(std::string const &db_name) {
   if (dbMap.count(db_name) == 0) {
     throw std::runtime_error("[OP-SQLite] DB is not open");
   }
 }
 
+/// Kept alive by the caller, the database may be closed meanwhile
+inline std::shared_ptr<ResultCache> get_result_cache(sqlite3 *db) {
+  std::lock_guard<std::mutex> lock(connectionMapsMutex);
+  auto it = resultCacheMap.find(db);
+  if (it == resultCacheMap.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+inline std::shared_ptr<ReaderPool> get_reader_pool(std::string const &db_name) {
+  std::lock_guard<std::mutex> lock(connectionMapsMutex);
+  auto it = readerPoolMap.find(db_name);
+  if (it == readerPoolMap.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+/// Drops the caches of a connection about to be closed, finalizing its cached
+/// statements, or the connection is never freed
+void forget_connection(sqlite3 *db) {
+  std::shared_ptr<StatementCache> statements;
+  std::shared_ptr<ResultCache> results;
+  {
+    std::lock_guard<std::mutex> lock(connectionMapsMutex);
+    auto statement_it = statementCacheMap.find(db);
+    if (statement_it != statementCacheMap.end()) {
+      statements = std::move(statement_it->second);
+      statementCacheMap.erase(statement_it);
+    }
+    auto result_it = resultCacheMap.find(db);
+    if (result_it != resultCacheMap.end()) {
+      results = std::move(result_it->second);
+      resultCacheMap.erase(result_it);
+    }
+  }
+  // Released outside of the lock, the last owner finalizes the statements
+}
+
+/// Records where the main connection stands after a call, for the reader
+/// pool and the result cache of the database. Done holding the connection
+/// mutex, which the update hook also runs under, so no write can slip in
+/// between reading the counters and settling them
+void settle_connection(std::string const &db_name) {
+  // Closed by the call
+  auto it = dbMap.find(db_name);
+  if (it == dbMap.end()) {
+    return;
+  }
+
+  sqlite3 *db = it->second;
+  std::shared_ptr<ResultCache> cache = get_result_cache(db);
+  std::shared_ptr<ReaderPool> pool = get_reader_pool(db_name);
+  if (cache == nullptr && pool == nullptr) {
+    return;
+  }
+
+  sqlite3_mutex *mutex = sqlite3_db_mutex(db);
+  sqlite3_mutex_enter(mutex);
+  bool autocommit = sqlite3_get_autocommit(db);
+  if (pool != nullptr) {
+    pool->main_autocommit = autocommit;
+  }
+  if (cache != nullptr) {
+    cache->settle(autocommit, sqlite3_total_changes(db));
+  }
+  sqlite3_mutex_leave(mutex);
+}
+
+/// Locks of the main connections opened with ownedConnection. They are
+/// opened with SQLITE_OPEN_NOMUTEX and every bridge call holds the lock for
+/// its whole duration, instead of SQLite taking its own mutex on each API
+/// call of the step loop. Recursive, since bridge calls nest
+std::unordered_map<std::string, std::shared_ptr<std::recursive_mutex>>
+    ownerLockMap =
+        std::unordered_map<std::string, std::shared_ptr<std::recursive_mutex>>();
+
+inline std::shared_ptr<std::recursive_mutex>
+get_owner_lock(std::string const &db_name) {
+  std::lock_guard<std::mutex> lock(connectionMapsMutex);
+  auto it = ownerLockMap.find(db_name);
+  if (it == ownerLockMap.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+/// Gives the calling thread the main connection of an owned database to
+/// itself for as long as it lives. Every call made on a main connection holds
+/// one, so it is also where the reader pool and the result cache learn that
+/// the call is over
+class ConnectionOwnership {
+public:
+  explicit ConnectionOwnership(std::string const &db_name, bool needed = true) {
+    if (!needed) {
+      return;
+    }
+
+    this->db_name = &db_name;
+    lock = get_owner_lock(db_name);
+    if (lock != nullptr) {
+      lock->lock();
+    }
+  }
+
+  ~ConnectionOwnership() {
+    if (db_name != nullptr) {
+      settle_connection(*db_name);
+    }
+
+    if (lock != nullptr) {
+      lock->unlock();
+    }
+  }
+
+  /// Whether no other thread can use the connection meanwhile, only owned
+  /// connections are locked
+  bool is_exclusive() const { return lock != nullptr; }
+
+  ConnectionOwnership(ConnectionOwnership const &) = delete;
+  ConnectionOwnership &operator=(ConnectionOwnership const &) = delete;
+
+private:
+  std::string const *db_name = nullptr;
+  // Kept alive by the owner, the database may be closed meanwhile
+  std::shared_ptr<std::recursive_mutex> lock;
+};
+
+inline std::shared_ptr<StatementCache> get_statement_cache(sqlite3 *db) {
+  std::lock_guard<std::mutex> lock(connectionMapsMutex);
+  auto it = statementCacheMap.find(db);
+  if (it == statementCacheMap.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+inline bool is_blank(const char *str) {
+  while (*str != '\0') {
+    if (!isspace(static_cast<unsigned char>(*str))) {
+      return false;
+    }
+    str++;
+  }
+  return true;
+}
+
+/// The authorizer never denies anything, it is only used to find out if a
+/// statement modifies the schema, and which tables it reads, while it is
+/// being prepared
+int authorizer_callback(void *, int action, const char *table, const char *,
+                        const char *, const char *) {
+  switch (action) {
+  case SQLITE_READ:
+    if (statementReadTables != nullptr && table != nullptr &&
+        std::find(statementReadTables->begin(), statementReadTables->end(),
+                  table) == statementReadTables->end()) {
+      statementReadTables->emplace_back(table);
+    }
+    break;
+
+  case SQLITE_CREATE_INDEX:
+  case SQLITE_CREATE_TABLE:
+  case SQLITE_CREATE_TEMP_INDEX:
+  case SQLITE_CREATE_TEMP_TABLE:
+  case SQLITE_CREATE_TEMP_TRIGGER:
+  case SQLITE_CREATE_TEMP_VIEW:
+  case SQLITE_CREATE_TRIGGER:
+  case SQLITE_CREATE_VIEW:
+  case SQLITE_CREATE_VTABLE:
+  case SQLITE_DROP_INDEX:
+  case SQLITE_DROP_TABLE:
+  case SQLITE_DROP_TEMP_INDEX:
+  case SQLITE_DROP_TEMP_TABLE:
+  case SQLITE_DROP_TEMP_TRIGGER:
+  case SQLITE_DROP_TEMP_VIEW:
+  case SQLITE_DROP_TRIGGER:
+  case SQLITE_DROP_VIEW:
+  case SQLITE_DROP_VTABLE:
+  case SQLITE_ALTER_TABLE:
+  case SQLITE_ATTACH:
+  case SQLITE_DETACH:
+  case SQLITE_REINDEX:
+  case SQLITE_ANALYZE:
+    statementChangesSchema = true;
+    break;
+  }
+
+  return SQLITE_OK;
+}
+
+/// Prepares the next statement of a query. A query made of a single statement
+/// is taken from the connection's statement cache when possible
+int acquire_statement(sqlite3 *db, std::string const &query,
+                      const char **remainingStatement,
+                      sqlite3_stmt **statement, StatementOrigin *origin) {
+  std::shared_ptr<StatementCache> cache = get_statement_cache(db);
+  bool isFirstStatement = *remainingStatement == nullptr;
+
+  // The authorizer only sees the tables read by statements being prepared
+  if (isFirstStatement && cache != nullptr && statementReadTables == nullptr) {
+    *statement = cache->acquire(query);
+    if (*statement != nullptr) {
+      *origin = Cacheable;
+      return SQLITE_OK;
+    }
+  }
+
+  const char *queryStr = isFirstStatement ? query.c_str() : *remainingStatement;
+
+  statementChangesSchema = false;
+  int status = sqlite3_prepare_v3(
+      db, queryStr, -1, isFirstStatement ? SQLITE_PREPARE_PERSISTENT : 0,
+      statement, remainingStatement);
+
+  if (statementChangesSchema) {
+    *origin = SchemaChange;
+  } else if (isFirstStatement && cache != nullptr &&
+             is_blank(*remainingStatement)) {
+    *origin = Cacheable;
+  } else {
+    *origin = Uncached;
+  }
+
+  return status;
+}
+
+inline std::vector<std::string> column_names(sqlite3_stmt *statement) {
+  int count = sqlite3_column_count(statement);
+  std::vector<std::string> names;
+  names.reserve(count);
+
+  for (int i = 0; i < count; i++) {
+    names.emplace_back(sqlite3_column_name(statement, i));
+  }
+
+  return names;
+}
+
+inline void add_metadata(sqlite3_stmt *statement,
+                         std::vector<SmartHostObject> *metadatas) {
+  int count = sqlite3_column_count(statement);
+
+  for (int i = 0; i < count; i++) {
+    const char *type = sqlite3_column_decltype(statement, i);
+    auto metadata = SmartHostObject();
+    metadata.fields.push_back(
+        std::make_pair("name", std::string(sqlite3_column_name(statement, i))));
+    metadata.fields.push_back(std::make_pair("index", i));
+    metadata.fields.push_back(
+        std::make_pair("type", type == NULL ? "UNKNOWN" : type));
+
+    metadatas->push_back(metadata);
+  }
+}
+
+/// Steps the statement until it is done, fails or the sink is full, handing
+/// every row to the sink. The decode plan is compiled on the first row.
+/// Returns the last result of sqlite3_step, SQLITE_ROW if the sink filled up
+template <typename Sink>
+int step_rows(sqlite3_stmt *statement, Sink &sink) {
+  DecodePlan<Sink> plan;
+  int result = SQLITE_ROW;
+
+  while (!sink.full() && (result = sqlite3_step(statement)) == SQLITE_ROW) {
+    if constexpr (Sink::decodes) {
+      if (!plan.compiled()) {
+        if (sink.needs_columns()) {
+          sink.set_columns(column_names(statement));
+        }
+        plan.compile(statement, sink.width());
+      }
+
+      plan.decode(statement, sink);
+    }
+
+    sink.end_row(plan.size());
+  }
+
+  return result;
+}
+
+void release_statement(sqlite3 *db, std::string const &query,
+                       sqlite3_stmt *statement, StatementOrigin origin) {
+  std::shared_ptr<StatementCache> cache = get_statement_cache(db);
+
+  if (origin == Cacheable && cache != nullptr) {
+    cache->release(query, statement);
+    return;
+  }
+
+  sqlite3_finalize(statement);
+
+  // Cached statements would be re-prepared by SQLite on their next step, drop
+  // them instead since they might reference objects that no longer exist
+  if (origin == SchemaChange && cache != nullptr) {
+    cache->clear();
+  }
+
+  // Same for cached results, their tables may be gone or different
+  std::shared_ptr<ResultCache> results = get_result_cache(db);
+  if (origin == SchemaChange && results != nullptr) {
+    results->clear();
+  }
+}
+
+/// Cheap check done before queueing a query, the statement itself is checked
+/// again with sqlite3_stmt_readonly once it is prepared on a reader
+inline bool is_select(const char *sql) {
+  while (isspace(static_cast<unsigned char>(*sql)) || *sql == '(') {
+    sql++;
+  }
+
+  for (const char *keyword : {"SELECT", "WITH"}) {
+    size_t length = strlen(keyword);
+    if (strncasecmp(sql, keyword, length) == 0 &&
+        !isalnum(static_cast<unsigned char>(sql[length]))) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/// Transaction control, ATTACH and some pragmas are also reported as read
+/// only by SQLite, but those are filtered out by is_select first
+inline bool is_read_only(sqlite3 *db, std::string const &query) {
+  sqlite3_stmt *statement;
+  const char *remainingStatement = nullptr;
+  StatementOrigin origin;
+
+  int status = acquire_statement(db, query, &remainingStatement, &statement,
+                                 &origin);
+
+  if (status != SQLITE_OK || statement == nullptr) {
+    return false;
+  }
+
+  bool read_only =
+      sqlite3_stmt_readonly(statement) != 0 &&
+      (remainingStatement == nullptr || is_blank(remainingStatement));
+
+  release_statement(db, query, statement, origin);
+
+  return read_only;
+}
+
+sqlite3 *checkout_reader(ReaderPool *pool) {
+  std::unique_lock<std::mutex> lock(pool->mutex);
+  pool->available.wait(lock,
+                       [&] { return !pool->idle.empty() || pool->closed; });
+
+  if (pool->closed) {
+    return nullptr;
+  }
+
+  sqlite3 *reader = pool->idle.back();
+  pool->idle.pop_back();
+  return reader;
+}
+
+void checkin_reader(ReaderPool *pool, sqlite3 *reader) {
+  std::lock_guard<std::mutex> lock(pool->mutex);
+  pool->idle.push_back(reader);
+  pool->available.notify_all();
+}
+
+/// Lends one of the read connections of the database. Queries that cannot
+/// run on a reader, because they write or use something only loaded on the
+/// main connection, fall back to the main connection and pool stays empty
+sqlite3 *checkout_connection(std::string const &dbName,
+                             std::string const &query,
+                             std::shared_ptr<ReaderPool> *pool) {
+  std::shared_ptr<ReaderPool> candidate = get_reader_pool(dbName);
+
+  if (candidate != nullptr) {
+    sqlite3 *reader = checkout_reader(candidate.get());
+
+    if (reader != nullptr) {
+      if (is_read_only(reader, query)) {
+        *pool = candidate;
+        return reader;
+      }
+
+      checkin_reader(candidate.get(), reader);
+    }
+  }
+
+  return dbMap[dbName];
+}
+
+/// Waits for the readers in use to be returned, queries running on them are
+/// interrupted
+void close_readers(std::string const &dbName) {
+  std::shared_ptr<ReaderPool> pool;
+  {
+    std::lock_guard<std::mutex> maps_lock(connectionMapsMutex);
+    auto it = readerPoolMap.find(dbName);
+    if (it == readerPoolMap.end()) {
+      return;
+    }
+
+    pool = it->second;
+    readerPoolMap.erase(it);
+  }
+
+  std::unique_lock<std::mutex> lock(pool->mutex);
+  pool->closed = true;
+  pool->available.notify_all();
+
+  for (sqlite3 *reader : pool->connections) {
+    sqlite3_interrupt(reader);
+  }
+
+  pool->available.wait(lock, [&] {
+    return pool->idle.size() == pool->connections.size();
+  });
+
+  for (sqlite3 *reader : pool->connections) {
+    forget_connection(reader);
+    sqlite3_close_v2(reader);
+  }
+
+  pool->connections.clear();
+  pool->idle.clear();
+}
+
+BridgeResult execute_on(sqlite3 *db, std::string const &query,
+                        const std::vector<JSVariant> *params,
+                        ResultBuffer *results,
+                        std::shared_ptr<std::vector<SmartHostObject>> metadatas,
+                        CancellationToken const *cancellation = nullptr,
+                        bool exclusive = false);
+
 //            _____ _____
 //      /\   |  __ \_   _|
 //     /  \  | |__) || |
@@ -53,17 +538,20 @@ BridgeResult opsqlite_open(std::string const &dbName,
                            std::string const &last_path,
                            std::string const &crsqlite_path,
                            std::string const &sqlite_vec_path,
-                           std::string const &encryptionKey) {
+                           std::string const &encryptionKey,
+                           bool owned_connection) {
 #else
 BridgeResult opsqlite_open(std::string const &dbName,
                            std::string const &last_path,
                            std::string const &crsqlite_path,
-                           std::string const &sqlite_vec_path) {
+                           std::string const &sqlite_vec_path,
+                           bool owned_connection) {
 #endif
   std::string dbPath = opsqlite_get_db_path(dbName, last_path);
 
   int sqlOpenFlags =
-      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX;
+      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE |
+      (owned_connection ? SQLITE_OPEN_NOMUTEX : SQLITE_OPEN_FULLMUTEX);
 
   sqlite3 *db;
 
@@ -75,11 +563,25 @@ BridgeResult opsqlite_open(std::string const &dbName,
 
   dbMap[dbName] = db;
 
+  if (owned_connection) {
+    std::lock_guard<std::mutex> lock(connectionMapsMutex);
+    ownerLockMap[dbName] = std::make_shared<std::recursive_mutex>();
+  }
+
 #ifdef OP_SQLITE_USE_SQLCIPHER
   opsqlite_execute(dbName, "PRAGMA key = '" + encryptionKey + "'", nullptr,
                    nullptr, nullptr);
 #endif
 
+  {
+    std::lock_guard<std::mutex> lock(connectionMapsMutex);
+    // Created after the key pragma so the key is never kept in the cache
+    statementCacheMap[db] = std::make_shared<StatementCache>();
+    // Off until setResultCache
+    resultCacheMap[db] = std::make_shared<ResultCache>();
+  }
+  sqlite3_set_authorizer(db, &authorizer_callback, nullptr);
+
   sqlite3_enable_load_extension(db, 1);
 
   char *errMsg;
@@ -113,9 +615,106 @@ BridgeResult opsqlite_open(std::string const &dbName,
   return {.type = SQLiteOk, .affectedRows = 0};
 }
 
+#ifdef OP_SQLITE_USE_SQLCIPHER
+BridgeResult opsqlite_open_readers(std::string const &dbName,
+                                   std::string const &last_path, int count,
+                                   std::string const &encryptionKey) {
+#else
+BridgeResult opsqlite_open_readers(std::string const &dbName,
+                                   std::string const &last_path, int count) {
+#endif
+  check_db_open(dbName);
+
+  std::string dbPath = opsqlite_get_db_path(dbName, last_path);
+
+  if (dbPath == ":memory:") {
+    return {.type = SQLiteError,
+            .message = "[op-sqlite] read connections are not available for "
+                       "in-memory databases"};
+  }
+
+  // Without mutexes (performanceMode 1) the state SQLite shares between
+  // connections is not protected, they cannot run on several threads at once
+  if (sqlite3_threadsafe() == 0) {
+    return {.type = SQLiteError,
+            .message = "[op-sqlite] read connections need SQLite compiled "
+                       "with SQLITE_THREADSAFE=1 or 2, not available with "
+                       "performanceMode 1"};
+  }
+
+  // Readers only run in parallel with the writer in WAL mode
+  BridgeResult result = opsqlite_execute(
+      dbName, "PRAGMA journal_mode = WAL", nullptr, nullptr, nullptr);
+
+  if (result.type == SQLiteError) {
+    return result;
+  }
+
+  auto pool = std::make_shared<ReaderPool>();
+  // Each reader is only used by one thread at a time
+  int sqlOpenFlags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+
+  for (int i = 0; i < count; i++) {
+    sqlite3 *reader;
+
+    int status =
+        sqlite3_open_v2(dbPath.c_str(), &reader, sqlOpenFlags, nullptr);
+
+    if (status != SQLITE_OK) {
+      std::string message = sqlite3_errmsg(reader);
+      sqlite3_close_v2(reader);
+
+      for (sqlite3 *opened : pool->connections) {
+        forget_connection(opened);
+        sqlite3_close_v2(opened);
+      }
+
+      return {.type = SQLiteError, .message = message};
+    }
+
+#ifdef OP_SQLITE_USE_SQLCIPHER
+    execute_on(reader, "PRAGMA key = '" + encryptionKey + "'", nullptr,
+               nullptr, nullptr);
+#endif
+
+    {
+      std::lock_guard<std::mutex> lock(connectionMapsMutex);
+      statementCacheMap[reader] = std::make_shared<StatementCache>();
+    }
+    sqlite3_set_authorizer(reader, &authorizer_callback, nullptr);
+
+    pool->connections.push_back(reader);
+    pool->idle.push_back(reader);
+  }
+
+  pool->main_autocommit = sqlite3_get_autocommit(dbMap[dbName]);
+  std::lock_guard<std::mutex> lock(connectionMapsMutex);
+  readerPoolMap[dbName] = pool;
+
+  return {.type = SQLiteOk};
+}
+
+/// Decides on the JS thread if a query can skip the queue of the database and
+/// run on a read connection in parallel with other queries
+bool opsqlite_should_use_reader(std::string const &dbName,
+                                std::string const &query) {
+  std::shared_ptr<ReaderPool> pool = get_reader_pool(dbName);
+  if (pool == nullptr || dbMap.count(dbName) == 0) {
+    return false;
+  }
+
+  // Reads inside a transaction need to see its uncommitted changes
+  if (!pool->main_autocommit) {
+    return false;
+  }
+
+  return is_select(query.c_str());
+}
+
 BridgeResult opsqlite_close(std::string const &dbName) {
 
   check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
   sqlite3 *db = dbMap[dbName];
 
@@ -124,9 +723,17 @@ BridgeResult opsqlite_close(std::string const &dbName) {
                    nullptr);
 #endif
 
+  close_readers(dbName);
+
+  forget_connection(db);
+
   sqlite3_close_v2(db);
 
   dbMap.erase(dbName);
+  {
+    std::lock_guard<std::mutex> lock(connectionMapsMutex);
+    ownerLockMap.erase(dbName);
+  }
 
   return BridgeResult{
       .type = SQLiteOk,
@@ -195,8 +802,13 @@ BridgeResult opsqlite_remove(std::string const &dbName,
   };
 }
 
-inline void opsqlite_bind_statement(sqlite3_stmt *statement,
-                                    const std::vector<JSVariant> *values) {
+/// Binds the values to the statement. SQLITE_STATIC skips the copy SQLite
+/// makes of strings and blobs, it can only be used when the values outlive
+/// every step of the statement, i.e. when the statement is reset before the
+/// caller returns
+inline void bind_values(sqlite3_stmt *statement,
+                        const std::vector<JSVariant> *values,
+                        sqlite3_destructor_type lifetime) {
   // reset any existing bound values
   sqlite3_clear_bindings(statement);
 
@@ -204,169 +816,107 @@ inline void opsqlite_bind_statement(sqlite3_stmt *statement,
 
   for (int ii = 0; ii < size; ii++) {
     int sqIndex = ii + 1;
-    JSVariant value = values->at(ii);
+    JSVariant const &value = values->at(ii);
 
     if (std::holds_alternative<bool>(value)) {
       sqlite3_bind_int(statement, sqIndex, std::get<bool>(value));
     } else if (std::holds_alternative<int>(value)) {
       sqlite3_bind_int(statement, sqIndex, std::get<int>(value));
     } else if (std::holds_alternative<long long>(value)) {
-      sqlite3_bind_double(statement, sqIndex, std::get<long long>(value));
+      sqlite3_bind_int64(statement, sqIndex, std::get<long long>(value));
     } else if (std::holds_alternative<double>(value)) {
       sqlite3_bind_double(statement, sqIndex, std::get<double>(value));
     } else if (std::holds_alternative<std::string>(value)) {
-      std::string str = std::get<std::string>(value);
+      std::string const &str = std::get<std::string>(value);
       sqlite3_bind_text(statement, sqIndex, str.c_str(), str.length(),
-                        SQLITE_TRANSIENT);
+                        lifetime);
     } else if (std::holds_alternative<ArrayBuffer>(value)) {
-      ArrayBuffer buffer = std::get<ArrayBuffer>(value);
+      ArrayBuffer const &buffer = std::get<ArrayBuffer>(value);
       sqlite3_bind_blob(statement, sqIndex, buffer.data.get(), buffer.size,
-                        SQLITE_TRANSIENT);
+                        lifetime);
     } else {
       sqlite3_bind_null(statement, sqIndex);
     }
   }
 }
 
+void opsqlite_bind_statement(std::string const &dbName,
+                             sqlite3_stmt *statement,
+                             const std::vector<JSVariant> *values) {
+  ConnectionOwnership ownership(dbName);
+  bind_values(statement, values, SQLITE_TRANSIENT);
+}
+
 BridgeResult opsqlite_execute_prepared_statement(
     std::string const &dbName, sqlite3_stmt *statement,
-    std::vector<DumbHostObject> *results,
+    ResultBuffer *results,
     std::shared_ptr<std::vector<SmartHostObject>> metadatas) {
 
   check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
   sqlite3 *db = dbMap[dbName];
 
-  const char *errorMessage;
-
-  bool isConsuming = true;
-  bool isFailed = false;
-
-  int result = SQLITE_OK;
-
-  isConsuming = true;
-
-  int i, count, column_type;
-  std::string column_name, column_declared_type;
-
-  while (isConsuming) {
-    result = sqlite3_step(statement);
-
-    switch (result) {
-    case SQLITE_ROW: {
-      if (results == NULL) {
-        break;
-      }
-
-      i = 0;
-      DumbHostObject row = DumbHostObject(metadatas);
-
-      count = sqlite3_column_count(statement);
-
-      while (i < count) {
-        column_type = sqlite3_column_type(statement, i);
-
-        switch (column_type) {
-        case SQLITE_INTEGER: {
-          /**
-           * Warning this will loose precision because JS can
-           * only represent Integers up to 53 bits
-           */
-          double column_value = sqlite3_column_double(statement, i);
-          row.values.push_back(JSVariant(column_value));
-          break;
-        }
-
-        case SQLITE_FLOAT: {
-          double column_value = sqlite3_column_double(statement, i);
-          row.values.push_back(JSVariant(column_value));
-          break;
-        }
+  int result;
+  if (results == nullptr) {
+    DiscardSink sink;
+    result = step_rows(statement, sink);
+  } else {
+    ResultBufferSink sink(results);
+    result = step_rows(statement, sink);
+  }
 
-        case SQLITE_TEXT: {
-          const char *column_value =
-              reinterpret_cast<const char *>(sqlite3_column_text(statement, i));
-          int byteLen = sqlite3_column_bytes(statement, i);
-          // Specify length too; in case string contains NULL in the middle
-          row.values.push_back(JSVariant(std::string(column_value, byteLen)));
-          break;
-        }
+  if (result != SQLITE_DONE) {
+    std::string errorMessage = sqlite3_errmsg(db);
+    sqlite3_reset(statement);
+    return {.type = SQLiteError,
+            .message = "[op-sqlite] SQLite code: " + std::to_string(result) +
+                       " execution error: " + errorMessage};
+  }
 
-        case SQLITE_BLOB: {
-          int blob_size = sqlite3_column_bytes(statement, i);
-          const void *blob = sqlite3_column_blob(statement, i);
-          uint8_t *data = new uint8_t[blob_size];
-          // You cannot share raw memory between native and JS
-          // always copy the data
-          memcpy(data, blob, blob_size);
-          row.values.push_back(
-              JSVariant(ArrayBuffer{.data = std::shared_ptr<uint8_t>{data},
-                                    .size = static_cast<size_t>(blob_size)}));
-          break;
-        }
+  if (metadatas != nullptr) {
+    add_metadata(statement, metadatas.get());
+  }
 
-        case SQLITE_NULL:
-          // Intentionally left blank
+  sqlite3_reset(statement);
 
-        default:
-          row.values.push_back(JSVariant(nullptr));
-          break;
-        }
-        i++;
-      }
-      if (results != nullptr) {
-        results->push_back(row);
-      }
-      break;
-    }
+  int changedRowCount = sqlite3_changes(db);
+  long long latestInsertRowId = sqlite3_last_insert_rowid(db);
 
-    case SQLITE_DONE:
-      if (metadatas != nullptr) {
-        i = 0;
-        count = sqlite3_column_count(statement);
+  return {.type = SQLiteOk,
+          .affectedRows = changedRowCount,
+          .insertId = static_cast<double>(latestInsertRowId)};
+}
 
-        while (i < count) {
-          column_name = sqlite3_column_name(statement, i);
-          const char *type = sqlite3_column_decltype(statement, i);
-          auto metadata = SmartHostObject();
-          metadata.fields.push_back(std::make_pair("name", column_name));
-          metadata.fields.push_back(std::make_pair("index", i));
-          metadata.fields.push_back(
-              std::make_pair("type", type == NULL ? "UNKNOWN" : type));
+/// Steps a statement for at most max_rows rows, used by cursors to read a
+/// result set in chunks. done is set once there are no more rows, the
+/// statement is not reset so the next call continues where this one stopped
+BridgeResult opsqlite_step_statement(std::string const &dbName,
+                                     sqlite3_stmt *statement, size_t max_rows,
+                                     ResultBuffer *results, bool *done) {
+  check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
-          metadatas->push_back(metadata);
-          i++;
-        }
-      }
-      isConsuming = false;
-      break;
+  sqlite3 *db = dbMap[dbName];
 
-    default:
-      errorMessage = sqlite3_errmsg(db);
-      isFailed = true;
-      isConsuming = false;
-    }
-  }
+  ResultBufferSink sink(results, max_rows);
+  int result = step_rows(statement, sink);
 
-  sqlite3_reset(statement);
+  *done = result != SQLITE_ROW;
 
-  if (isFailed) {
+  if (result != SQLITE_ROW && result != SQLITE_DONE) {
     return {.type = SQLiteError,
             .message = "[op-sqlite] SQLite code: " + std::to_string(result) +
-                       " execution error: " + std::string(errorMessage)};
+                       " execution error: " + std::string(sqlite3_errmsg(db))};
   }
 
-  int changedRowCount = sqlite3_changes(db);
-  long long latestInsertRowId = sqlite3_last_insert_rowid(db);
-
-  return {.type = SQLiteOk,
-          .affectedRows = changedRowCount,
-          .insertId = static_cast<double>(latestInsertRowId)};
+  return {.type = SQLiteOk};
 }
 
 sqlite3_stmt *opsqlite_prepare_statement(std::string const &dbName,
                                          std::string const &query) {
   check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
   sqlite3 *db = dbMap[dbName];
 
@@ -385,32 +935,32 @@ sqlite3_stmt *opsqlite_prepare_statement(std::string const &dbName,
   return statement;
 }
 
-/// Base execution function, returns HostObjects to the JS environment
-BridgeResult
-opsqlite_execute(std::string const &dbName, std::string const &query,
-                 const std::vector<JSVariant> *params,
-                 std::vector<DumbHostObject> *results,
-                 std::shared_ptr<std::vector<SmartHostObject>> metadatas) {
-
-  check_db_open(dbName);
-
-  sqlite3 *db = dbMap[dbName];
+void opsqlite_finalize_statement(std::string const &dbName,
+                                 sqlite3_stmt *statement) {
+  ConnectionOwnership ownership(dbName);
+  sqlite3_finalize(statement);
+}
 
+/// Runs every statement of the query, the rows of all of them go to the sink.
+/// A sink whose rows share their columns fails the query when a statement
+/// has other columns than the rows already read, instead of losing them
+template <typename Sink>
+BridgeResult execute_into(sqlite3 *db, std::string const &query,
+                          const std::vector<JSVariant> *params, Sink &sink,
+                          std::vector<SmartHostObject> *metadatas) {
   sqlite3_stmt *statement;
-  const char *errorMessage;
+  std::string errorMessage;
   const char *remainingStatement = nullptr;
 
-  bool isConsuming = true;
   bool isFailed = false;
+  std::vector<std::string> shape;
 
   int result = SQLITE_OK;
 
   do {
-    const char *queryStr =
-        remainingStatement == nullptr ? query.c_str() : remainingStatement;
-
-    int statementStatus =
-        sqlite3_prepare_v2(db, queryStr, -1, &statement, &remainingStatement);
+    StatementOrigin origin;
+    int statementStatus = acquire_statement(db, query, &remainingStatement,
+                                            &statement, &origin);
 
     if (statementStatus != SQLITE_OK) {
       const char *message = sqlite3_errmsg(db);
@@ -428,114 +978,39 @@ opsqlite_execute(std::string const &dbName, std::string const &query,
     }
 
     if (params != nullptr && params->size() > 0) {
-      opsqlite_bind_statement(statement, params);
+      bind_values(statement, params, SQLITE_STATIC);
     }
 
-    isConsuming = true;
-
-    int i, count, column_type;
-    std::string column_name, column_declared_type;
-
-    while (isConsuming) {
-      result = sqlite3_step(statement);
-
-      switch (result) {
-      case SQLITE_ROW: {
-        if (results == NULL) {
-          break;
+    if (sqlite3_column_count(statement) > 0 &&
+        (Sink::decodes || metadatas != nullptr)) {
+      std::vector<std::string> names = column_names(statement);
+      if (names != shape) {
+        if constexpr (Sink::decodes) {
+          if (!sink.can_reshape()) {
+            release_statement(db, query, statement, origin);
+            return {.type = SQLiteError,
+                    .message = "[op-sqlite] The statements of the query return "
+                               "rows with different columns, run them "
+                               "separately"};
+          }
+          sink.set_columns(names);
         }
+        if (metadatas != nullptr) {
+          metadatas->clear();
+          add_metadata(statement, metadatas);
+        }
+        shape = std::move(names);
+      }
+    }
 
-        i = 0;
-        DumbHostObject row = DumbHostObject(metadatas);
-
-        count = sqlite3_column_count(statement);
+    result = step_rows(statement, sink);
 
-        while (i < count) {
-          column_type = sqlite3_column_type(statement, i);
+    if (result != SQLITE_DONE) {
+      errorMessage = sqlite3_errmsg(db);
+      isFailed = true;
+    }
 
-          switch (column_type) {
-          case SQLITE_INTEGER: {
-            /**
-             * Warning this will loose precision because JS can
-             * only represent Integers up to 53 bits
-             */
-            double column_value = sqlite3_column_double(statement, i);
-            row.values.push_back(JSVariant(column_value));
-            break;
-          }
-
-          case SQLITE_FLOAT: {
-            double column_value = sqlite3_column_double(statement, i);
-            row.values.push_back(JSVariant(column_value));
-            break;
-          }
-
-          case SQLITE_TEXT: {
-            const char *column_value = reinterpret_cast<const char *>(
-                sqlite3_column_text(statement, i));
-            int byteLen = sqlite3_column_bytes(statement, i);
-            // Specify length too; in case string contains NULL in the middle
-            row.values.push_back(JSVariant(std::string(column_value, byteLen)));
-            break;
-          }
-
-          case SQLITE_BLOB: {
-            int blob_size = sqlite3_column_bytes(statement, i);
-            const void *blob = sqlite3_column_blob(statement, i);
-            uint8_t *data = new uint8_t[blob_size];
-            // You cannot share raw memory between native and JS
-            // always copy the data
-            memcpy(data, blob, blob_size);
-            row.values.push_back(
-                JSVariant(ArrayBuffer{.data = std::shared_ptr<uint8_t>{data},
-                                      .size = static_cast<size_t>(blob_size)}));
-            break;
-          }
-
-          case SQLITE_NULL:
-            // Intentionally left blank
-
-          default:
-            row.values.push_back(JSVariant(nullptr));
-            break;
-          }
-          i++;
-        }
-        if (results != nullptr) {
-          results->push_back(row);
-        }
-        break;
-      }
-
-      case SQLITE_DONE:
-        if (metadatas != nullptr) {
-          i = 0;
-          count = sqlite3_column_count(statement);
-
-          while (i < count) {
-            column_name = sqlite3_column_name(statement, i);
-            const char *type = sqlite3_column_decltype(statement, i);
-            auto metadata = SmartHostObject();
-            metadata.fields.push_back(std::make_pair("name", column_name));
-            metadata.fields.push_back(std::make_pair("index", i));
-            metadata.fields.push_back(
-                std::make_pair("type", type == NULL ? "UNKNOWN" : type));
-
-            metadatas->push_back(metadata);
-            i++;
-          }
-        }
-        isConsuming = false;
-        break;
-
-      default:
-        errorMessage = sqlite3_errmsg(db);
-        isFailed = true;
-        isConsuming = false;
-      }
-    }
-
-    sqlite3_finalize(statement);
+    release_statement(db, query, statement, origin);
   } while (remainingStatement != NULL && strcmp(remainingStatement, "") != 0 &&
            !isFailed);
 
@@ -544,7 +1019,7 @@ opsqlite_execute(std::string const &dbName, std::string const &query,
     return {.type = SQLiteError,
             .message =
                 "[op-sqlite] SQLite error code: " + std::to_string(result) +
-                ", description: " + std::string(errorMessage)};
+                ", description: " + errorMessage};
   }
 
   int changedRowCount = sqlite3_changes(db);
@@ -555,169 +1030,172 @@ opsqlite_execute(std::string const &dbName, std::string const &query,
           .insertId = static_cast<double>(latestInsertRowId)};
 }
 
-/// Executes returning data in raw arrays, a small performance optimization
-/// for certain use cases
-BridgeResult
-opsqlite_execute_raw(std::string const &dbName, std::string const &query,
-                     const std::vector<JSVariant> *params,
-                     std::vector<std::vector<JSVariant>> *results) {
-
-  check_db_open(dbName);
-
-  sqlite3 *db = dbMap[dbName];
-
-  sqlite3_stmt *statement;
-  const char *errorMessage;
-  const char *remainingStatement = nullptr;
-
-  bool isConsuming = true;
-  bool isFailed = false;
-
-  int step = SQLITE_OK;
-
-  do {
-    const char *queryStr =
-        remainingStatement == nullptr ? query.c_str() : remainingStatement;
-
-    int statementStatus =
-        sqlite3_prepare_v2(db, queryStr, -1, &statement, &remainingStatement);
-
-    if (statementStatus != SQLITE_OK) {
-      const char *message = sqlite3_errmsg(db);
-      return {
-          .type = SQLiteError,
-          .message = "[op-sqlite] SQL statement error:" +
-                     std::to_string(statementStatus) +
-                     " description:" + std::string(message),
-      };
-    }
+/// Called by SQLite while a query with a cancellation token runs, a non zero
+/// return stops the statement with SQLITE_INTERRUPT
+int progress_callback(void *cancellation) {
+  return static_cast<CancellationToken const *>(cancellation)->should_stop();
+}
 
-    // The statement did not fail to parse but there is nothing to do, just
-    // skip to the end
-    if (statement == NULL) {
-      continue;
-    }
+/// Number of virtual machine instructions between two progress callbacks,
+/// small enough to stop a long query within a millisecond or so
+const int PROGRESS_INSTRUCTIONS = 1000;
+
+/// A cancellation is checked before the query runs. It stops a running query
+/// only when the caller has the connection to itself, exclusive, since the
+/// progress handler applies to every statement running on the connection
+BridgeResult execute_on(sqlite3 *db, std::string const &query,
+                        const std::vector<JSVariant> *params,
+                        ResultBuffer *results,
+                        std::shared_ptr<std::vector<SmartHostObject>> metadatas,
+                        CancellationToken const *cancellation, bool exclusive) {
+  if (cancellation != nullptr && cancellation->should_stop()) {
+    return {.type = SQLiteError, .message = cancellation->reason()};
+  }
 
-    if (params != nullptr && params->size() > 0) {
-      opsqlite_bind_statement(statement, params);
+  if (cancellation == nullptr || !exclusive) {
+    if (results == nullptr) {
+      DiscardSink sink;
+      return execute_into(db, query, params, sink, metadatas.get());
     }
 
-    isConsuming = true;
+    ResultBufferSink sink(results);
+    return execute_into(db, query, params, sink, metadatas.get());
+  }
 
-    int i, count, column_type;
-    std::string column_name, column_declared_type;
+  // The handler only sees the statements of this query. sqlite3_interrupt is
+  // not used because it stops whatever runs on the connection when it is
+  // called
+  sqlite3_progress_handler(db, PROGRESS_INSTRUCTIONS, progress_callback,
+                           const_cast<CancellationToken *>(cancellation));
 
-    while (isConsuming) {
-      step = sqlite3_step(statement);
+  BridgeResult result;
+  if (results == nullptr) {
+    DiscardSink sink;
+    result = execute_into(db, query, params, sink, metadatas.get());
+  } else {
+    ResultBufferSink sink(results);
+    result = execute_into(db, query, params, sink, metadatas.get());
+  }
 
-      switch (step) {
-      case SQLITE_ROW: {
-        if (results == nullptr) {
-          break;
-        }
+  sqlite3_progress_handler(db, 0, nullptr, nullptr);
 
-        std::vector<JSVariant> row;
+  if (result.type == SQLiteError && cancellation->should_stop()) {
+    result.message = cancellation->reason();
+  }
 
-        i = 0;
+  return result;
+}
 
-        count = sqlite3_column_count(statement);
+BridgeResult execute_raw_on(sqlite3 *db, std::string const &query,
+                            const std::vector<JSVariant> *params,
+                            std::vector<std::vector<JSVariant>> *results) {
+  if (results == nullptr) {
+    DiscardSink sink;
+    return execute_into(db, query, params, sink, nullptr);
+  }
 
-        while (i < count) {
-          column_type = sqlite3_column_type(statement, i);
+  VariantRowsSink sink(results);
+  return execute_into(db, query, params, sink, nullptr);
+}
 
-          switch (column_type) {
-          case SQLITE_INTEGER: {
-            /**
-             * Warning this will loose precision because JS can
-             * only represent Integers up to 53 bits
-             */
-            double column_value = sqlite3_column_double(statement, i);
-            row.push_back(JSVariant(column_value));
-            break;
-          }
+/// Base execution function, returns HostObjects to the JS environment
+BridgeResult
+opsqlite_execute(std::string const &dbName, std::string const &query,
+                 const std::vector<JSVariant> *params, ResultBuffer *results,
+                 std::shared_ptr<std::vector<SmartHostObject>> metadatas,
+                 CancellationToken const *cancellation) {
+  check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
-          case SQLITE_FLOAT: {
-            double column_value = sqlite3_column_double(statement, i);
-            row.push_back(JSVariant(column_value));
-            break;
-          }
+  return execute_on(dbMap[dbName], query, params, results, metadatas,
+                    cancellation, ownership.is_exclusive());
+}
 
-          case SQLITE_TEXT: {
-            const char *column_value = reinterpret_cast<const char *>(
-                sqlite3_column_text(statement, i));
-            int byteLen = sqlite3_column_bytes(statement, i);
-            // Specify length too; in case string contains NULL in the middle
-            row.push_back(JSVariant(std::string(column_value, byteLen)));
-            break;
-          }
+/// Executes returning data in raw arrays, a small performance optimization
+/// for certain use cases
+BridgeResult
+opsqlite_execute_raw(std::string const &dbName, std::string const &query,
+                     const std::vector<JSVariant> *params,
+                     std::vector<std::vector<JSVariant>> *results) {
+  check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
-          case SQLITE_BLOB: {
-            int blob_size = sqlite3_column_bytes(statement, i);
-            const void *blob = sqlite3_column_blob(statement, i);
-            uint8_t *data = new uint8_t[blob_size];
-            memcpy(data, blob, blob_size);
-            row.push_back(
-                JSVariant(ArrayBuffer{.data = std::shared_ptr<uint8_t>{data},
-                                      .size = static_cast<size_t>(blob_size)}));
-            break;
-          }
+  return execute_raw_on(dbMap[dbName], query, params, results);
+}
 
-          case SQLITE_NULL:
-            row.push_back(JSVariant(nullptr));
-            break;
+/// Same as opsqlite_execute but runs on one of the read connections, see
+/// opsqlite_should_use_reader
+BridgeResult
+opsqlite_execute_read(std::string const &dbName, std::string const &query,
+                      const std::vector<JSVariant> *params,
+                      ResultBuffer *results,
+                      std::shared_ptr<std::vector<SmartHostObject>> metadatas,
+                      CancellationToken const *cancellation) {
+  check_db_open(dbName);
 
-          default:
-            row.push_back(JSVariant(nullptr));
-            break;
-          }
-          i++;
-        }
+  std::shared_ptr<ReaderPool> pool;
+  sqlite3 *db = checkout_connection(dbName, query, &pool);
+  // Fell back to the main connection
+  ConnectionOwnership ownership(dbName, pool == nullptr);
 
-        results->push_back(row);
+  BridgeResult result =
+      execute_on(db, query, params, results, metadatas, cancellation,
+                 pool != nullptr || ownership.is_exclusive());
 
-        break;
-      }
+  if (pool != nullptr) {
+    checkin_reader(pool.get(), db);
+  }
 
-      case SQLITE_DONE:
-        isConsuming = false;
-        break;
+  return result;
+}
 
-      default:
-        errorMessage = sqlite3_errmsg(db);
-        isFailed = true;
-        isConsuming = false;
-      }
-    }
+BridgeResult
+opsqlite_execute_raw_read(std::string const &dbName, std::string const &query,
+                          const std::vector<JSVariant> *params,
+                          std::vector<std::vector<JSVariant>> *results) {
+  check_db_open(dbName);
 
-    sqlite3_finalize(statement);
-  } while (remainingStatement != NULL && strcmp(remainingStatement, "") != 0 &&
-           !isFailed);
+  std::shared_ptr<ReaderPool> pool;
+  sqlite3 *db = checkout_connection(dbName, query, &pool);
+  // Fell back to the main connection
+  ConnectionOwnership ownership(dbName, pool == nullptr);
 
-  if (isFailed) {
+  BridgeResult result = execute_raw_on(db, query, params, results);
 
-    return {.type = SQLiteError,
-            .message =
-                "[op-sqlite] SQLite error code: " + std::to_string(step) +
-                ", description: " + std::string(errorMessage)};
+  if (pool != nullptr) {
+    checkin_reader(pool.get(), db);
   }
 
-  int changedRowCount = sqlite3_changes(db);
-  long long latestInsertRowId = sqlite3_last_insert_rowid(db);
-
-  return {.type = SQLiteOk,
-          .affectedRows = changedRowCount,
-          .insertId = static_cast<double>(latestInsertRowId)};
+  return result;
 }
 
 void opsqlite_close_all() {
   for (auto const &x : dbMap) {
+    close_readers(x.first);
+
     // Interrupt will make all pending operations to fail with
     // SQLITE_INTERRUPT The ongoing work from threads will then fail ASAP
     sqlite3_interrupt(x.second);
+
+    // An owned connection is only closed once the worker using it let go
+    std::shared_ptr<std::recursive_mutex> owner = get_owner_lock(x.first);
+    if (owner != nullptr) {
+      owner->lock();
+    }
+
+    forget_connection(x.second);
     // Each DB connection can then be safely interrupted
     sqlite3_close_v2(x.second);
+
+    if (owner != nullptr) {
+      owner->unlock();
+    }
   }
   dbMap.clear();
+  {
+    std::lock_guard<std::mutex> lock(connectionMapsMutex);
+    ownerLockMap.clear();
+  }
   updateCallbackMap.clear();
   rollbackCallbackMap.clear();
   commitCallbackMap.clear();
@@ -742,17 +1220,33 @@ std::string operation_to_string(int operation_type) {
 void update_callback(void *dbName, int operation_type, char const *database,
                      char const *table, sqlite3_int64 rowid) {
   std::string &strDbName = *(static_cast<std::string *>(dbName));
+
+  std::shared_ptr<ResultCache> cache = get_result_cache(dbMap[strDbName]);
+  if (cache != nullptr) {
+    cache->table_changed(table);
+  }
+
+  if (updateCallbackMap.count(strDbName) == 0) {
+    return;
+  }
+
   auto callback = updateCallbackMap[strDbName];
   callback(strDbName, std::string(table), operation_to_string(operation_type),
            static_cast<int>(rowid));
 }
 
-BridgeResult opsqlite_register_update_hook(std::string const &dbName,
-                                           UpdateCallback const callback) {
-  check_db_open(dbName);
-
+/// The update hook is shared by the JS callback and the result cache, it is
+/// installed while either of them needs it
+void install_update_hook(std::string const &dbName) {
   sqlite3 *db = dbMap[dbName];
-  updateCallbackMap[dbName] = callback;
+  std::shared_ptr<ResultCache> cache = get_result_cache(db);
+
+  if (updateCallbackMap.count(dbName) == 0 &&
+      (cache == nullptr || !cache->enabled())) {
+    sqlite3_update_hook(db, NULL, NULL);
+    return;
+  }
+
   const std::string *key = nullptr;
 
   // TODO find a more elegant way to retrieve a reference to the key
@@ -763,17 +1257,25 @@ BridgeResult opsqlite_register_update_hook(std::string const &dbName,
   }
 
   sqlite3_update_hook(db, &update_callback, (void *)key);
+}
+
+BridgeResult opsqlite_register_update_hook(std::string const &dbName,
+                                           UpdateCallback const callback) {
+  check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
+
+  updateCallbackMap[dbName] = callback;
+  install_update_hook(dbName);
 
   return {SQLiteOk};
 }
 
 BridgeResult opsqlite_deregister_update_hook(std::string const &dbName) {
   check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
-  sqlite3 *db = dbMap[dbName];
   updateCallbackMap.erase(dbName);
-
-  sqlite3_update_hook(db, NULL, NULL);
+  install_update_hook(dbName);
 
   return {SQLiteOk};
 }
@@ -789,6 +1291,7 @@ int commit_callback(void *dbName) {
 BridgeResult opsqlite_register_commit_hook(std::string const &dbName,
                                            CommitCallback const callback) {
   check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
   sqlite3 *db = dbMap[dbName];
   commitCallbackMap[dbName] = callback;
@@ -808,6 +1311,7 @@ BridgeResult opsqlite_register_commit_hook(std::string const &dbName,
 
 BridgeResult opsqlite_deregister_commit_hook(std::string const &dbName) {
   check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
   sqlite3 *db = dbMap[dbName];
   commitCallbackMap.erase(dbName);
@@ -825,6 +1329,7 @@ void rollback_callback(void *dbName) {
 BridgeResult opsqlite_register_rollback_hook(std::string const &dbName,
                                              RollbackCallback const callback) {
   check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
   sqlite3 *db = dbMap[dbName];
   rollbackCallbackMap[dbName] = callback;
@@ -844,6 +1349,7 @@ BridgeResult opsqlite_register_rollback_hook(std::string const &dbName,
 
 BridgeResult opsqlite_deregister_rollback_hook(std::string const &dbName) {
   check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
 
   sqlite3 *db = dbMap[dbName];
   rollbackCallbackMap.erase(dbName);
@@ -853,6 +1359,324 @@ BridgeResult opsqlite_deregister_rollback_hook(std::string const &dbName) {
   return {SQLiteOk};
 }
 
+inline std::string quote_identifier(std::string const &name) {
+  std::string quoted = "\"";
+  for (char c : name) {
+    if (c == '"') {
+      quoted += '"';
+    }
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+/// Inserts rows given column by column. A single cached statement is rebound
+/// for every row, straight from the memory of the typed arrays
+BatchResult opsqlite_insert_columns(std::string const &dbName,
+                                    std::string const &table,
+                                    std::vector<ColumnValues> const &columns,
+                                    size_t rows) {
+  if (dbMap.count(dbName) == 0) {
+    return BatchResult{
+        .type = SQLiteError,
+        .message = "[OP-SQLite] DB is not open",
+    };
+  }
+
+  ConnectionOwnership ownership(dbName);
+  sqlite3 *db = dbMap[dbName];
+
+  std::string query = "INSERT INTO " + quote_identifier(table) + " (";
+  std::string placeholders;
+  for (size_t i = 0; i < columns.size(); i++) {
+    query += (i == 0 ? "" : ", ") + quote_identifier(columns[i].name);
+    placeholders += i == 0 ? "?" : ", ?";
+  }
+  query += ") VALUES (" + placeholders + ")";
+
+  // Same as batches, a transaction that is already open is only extended
+  bool nested = !sqlite3_get_autocommit(db);
+  const int savepoint = 0;
+
+  BridgeResult begin =
+      nested ? opsqlite_transaction_command(dbName, SavepointCommand, savepoint)
+             : opsqlite_transaction_command(dbName, BeginImmediateCommand);
+
+  if (begin.type == SQLiteError) {
+    return BatchResult{
+        .type = SQLiteError,
+        .message = begin.message,
+    };
+  }
+
+  sqlite3_stmt *statement;
+  const char *remainingStatement = nullptr;
+  StatementOrigin origin;
+  std::string errorMessage;
+
+  int status = acquire_statement(db, query, &remainingStatement, &statement,
+                                 &origin);
+
+  if (status != SQLITE_OK) {
+    errorMessage = sqlite3_errmsg(db);
+    statement = nullptr;
+  }
+
+  for (size_t row = 0; statement != nullptr && row < rows; row++) {
+    for (size_t i = 0; i < columns.size(); i++) {
+      auto const &column = columns[i];
+      int index = static_cast<int>(i) + 1;
+
+      switch (column.type) {
+      case Float64Column:
+        sqlite3_bind_double(statement, index,
+                            static_cast<const double *>(column.numbers)[row]);
+        break;
+      case Int32Column:
+        sqlite3_bind_int(statement, index,
+                         static_cast<const int32_t *>(column.numbers)[row]);
+        break;
+      case TextColumn:
+        if (std::holds_alternative<std::string>(column.texts[row])) {
+          auto const &text = std::get<std::string>(column.texts[row]);
+          sqlite3_bind_text(statement, index, text.c_str(),
+                            static_cast<int>(text.length()), SQLITE_STATIC);
+        } else {
+          sqlite3_bind_null(statement, index);
+        }
+        break;
+      }
+    }
+
+    status = sqlite3_step(statement);
+    if (status != SQLITE_DONE) {
+      errorMessage = sqlite3_errmsg(db);
+    }
+    sqlite3_reset(statement);
+
+    if (status != SQLITE_DONE) {
+      break;
+    }
+  }
+
+  if (statement != nullptr) {
+    release_statement(db, query, statement, origin);
+  }
+
+  BridgeResult end;
+
+  if (errorMessage.empty()) {
+    end = nested
+              ? opsqlite_transaction_command(dbName, ReleaseCommand, savepoint)
+              : opsqlite_transaction_command(dbName, CommitCommand);
+  } else {
+    end = {.type = SQLiteError,
+           .message = "[op-sqlite] SQLite error code: " +
+                      std::to_string(status) +
+                      ", description: " + errorMessage};
+  }
+
+  if (end.type == SQLiteError) {
+    if (nested) {
+      opsqlite_transaction_command(dbName, RollbackToCommand, savepoint);
+      opsqlite_transaction_command(dbName, ReleaseCommand, savepoint);
+    } else if (!sqlite3_get_autocommit(db)) {
+      opsqlite_transaction_command(dbName, RollbackCommand);
+    }
+
+    return BatchResult{
+        .type = SQLiteError,
+        .message = end.message,
+    };
+  }
+
+  return BatchResult{
+      .type = SQLiteOk,
+      .affectedRows = static_cast<int>(rows),
+      .commands = static_cast<int>(rows),
+  };
+}
+
+/// Whether the database was opened with ownedConnection, a query can only be
+/// stopped while it runs when its caller has the connection to itself
+bool opsqlite_is_owned_connection(std::string const &dbName) {
+  return get_owner_lock(dbName) != nullptr;
+}
+
+/// Whether the main connection is inside a transaction, which statements
+/// can also end on their own with ON CONFLICT ROLLBACK or RAISE(ROLLBACK)
+bool opsqlite_in_transaction(std::string const &dbName) {
+  check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
+
+  return !sqlite3_get_autocommit(dbMap[dbName]);
+}
+
+/// Runs transaction control from the statement cache, so transactions and
+/// savepoints do not parse their SQL every time
+BridgeResult opsqlite_transaction_command(std::string const &dbName,
+                                          TransactionCommand command,
+                                          int savepoint) {
+  check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
+
+  std::string query;
+  switch (command) {
+  case BeginCommand:
+    query = "BEGIN TRANSACTION";
+    break;
+  case BeginImmediateCommand:
+    query = "BEGIN IMMEDIATE TRANSACTION";
+    break;
+  case BeginExclusiveCommand:
+    query = "BEGIN EXCLUSIVE TRANSACTION";
+    break;
+  case CommitCommand:
+    query = "COMMIT";
+    break;
+  case RollbackCommand:
+    query = "ROLLBACK";
+    break;
+  case SavepointCommand:
+    query = "SAVEPOINT opsqlite_savepoint_" + std::to_string(savepoint);
+    break;
+  case ReleaseCommand:
+    query = "RELEASE opsqlite_savepoint_" + std::to_string(savepoint);
+    break;
+  case RollbackToCommand:
+    query = "ROLLBACK TO opsqlite_savepoint_" + std::to_string(savepoint);
+    break;
+  }
+
+  sqlite3 *db = dbMap[dbName];
+  sqlite3_stmt *statement;
+  const char *remainingStatement = nullptr;
+  StatementOrigin origin;
+
+  int status = acquire_statement(db, query, &remainingStatement, &statement,
+                                 &origin);
+
+  if (status == SQLITE_OK) {
+    status = sqlite3_step(statement);
+  }
+
+  if (status != SQLITE_DONE) {
+    std::string message = sqlite3_errmsg(db);
+
+    if (statement != nullptr) {
+      release_statement(db, query, statement, origin);
+    }
+
+    return {.type = SQLiteError,
+            .message = "[op-sqlite] SQLite error code: " +
+                       std::to_string(status) + ", description: " + message};
+  }
+
+  release_statement(db, query, statement, origin);
+
+  return {.type = SQLiteOk};
+}
+
+StatementCacheStats
+opsqlite_get_statement_cache_stats(std::string const &dbName) {
+  check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
+
+  std::shared_ptr<StatementCache> cache = get_statement_cache(dbMap[dbName]);
+  if (cache == nullptr) {
+    return {};
+  }
+
+  return cache->stats();
+}
+
+void opsqlite_set_result_cache(std::string const &dbName,
+                               ResultCacheOptions const &options) {
+  check_db_open(dbName);
+  ConnectionOwnership ownership(dbName);
+
+  sqlite3 *db = dbMap[dbName];
+  std::shared_ptr<ResultCache> cache = get_result_cache(db);
+
+  sqlite3_mutex *mutex = sqlite3_db_mutex(db);
+  sqlite3_mutex_enter(mutex);
+  cache->configure(options, sqlite3_total_changes(db));
+  install_update_hook(dbName);
+  sqlite3_mutex_leave(mutex);
+}
+
+ResultCacheStats opsqlite_get_result_cache_stats(std::string const &dbName) {
+  check_db_open(dbName);
+
+  return get_result_cache(dbMap[dbName])->stats();
+}
+
+bool opsqlite_cached_result(std::string const &dbName, std::string const &key,
+                            CachedResult *result) {
+  check_db_open(dbName);
+
+  return get_result_cache(dbMap[dbName])->lookup(key, result);
+}
+
+/// Runs a query whose result is then kept in the result cache. Its statements
+/// are always prepared instead of taken from the statement cache, so the
+/// authorizer sees every table they read
+BridgeResult
+opsqlite_execute_cached(std::string const &dbName, std::string const &query,
+                        const std::vector<JSVariant> *params,
+                        std::string const &key, bool use_reader,
+                        std::shared_ptr<ResultBuffer> results,
+                        std::shared_ptr<std::vector<SmartHostObject>> metadatas,
+                        CancellationToken const *cancellation) {
+  check_db_open(dbName);
+
+  // Kept alive until the result is stored, the database may be closed
+  // meanwhile
+  std::shared_ptr<ResultCache> cache = get_result_cache(dbMap[dbName]);
+  uint64_t started = cache->epoch();
+
+  std::vector<std::string> tables;
+  BridgeResult result;
+
+  std::shared_ptr<ReaderPool> pool;
+  sqlite3 *db = use_reader ? checkout_connection(dbName, query, &pool)
+                           : dbMap[dbName];
+  bool autocommit;
+
+  statementReadTables = &tables;
+  try {
+    // Read from the connection that ran the query while the call still has
+    // it, the main one may be used by another call right after
+    ConnectionOwnership ownership(dbName, pool == nullptr);
+    result = execute_on(db, query, params, results.get(), metadatas,
+                        cancellation,
+                        pool != nullptr || ownership.is_exclusive());
+    autocommit = sqlite3_get_autocommit(db);
+  } catch (...) {
+    statementReadTables = nullptr;
+    if (pool != nullptr) {
+      checkin_reader(pool.get(), db);
+    }
+    throw;
+  }
+  statementReadTables = nullptr;
+
+  if (pool != nullptr) {
+    checkin_reader(pool.get(), db);
+  }
+
+  // Rows read inside a transaction may include writes that are rolled back
+  if (result.type == SQLiteOk && autocommit) {
+    // Handed to every caller served from the cache. The counters of the
+    // connection are those of its last write, they are not kept
+    results->copy_blobs = true;
+    cache->store(key, {BridgeResult{.type = SQLiteOk}, results, metadatas},
+                 std::move(tables), started);
+  }
+
+  return result;
+}
+
 BridgeResult opsqlite_load_extension(std::string const &db_name,
                                      std::string &path,
                                      std::string &entry_point) {
@@ -861,6 +1685,7 @@ BridgeResult opsqlite_load_extension(std::string const &db_name,
       "Embedded version of SQLite does not support loading extensions");
 #else
   check_db_open(db_name);
+  ConnectionOwnership ownership(db_name);
 
   sqlite3 *db = dbMap[db_name];
   int loading_extensions_enabled = sqlite3_enable_load_extension(db, 1);
@@ -884,8 +1709,78 @@ BridgeResult opsqlite_load_extension(std::string const &db_name,
 #endif
 }
 
+/// Runs one command of a batch. The statement of the previous command is
+/// kept while the SQL does not change, so a command repeated with many
+/// parameter sets is prepared once and only rebound
+BridgeResult execute_batch_command(sqlite3 *db, BatchArguments const &command,
+                                   std::string const **statementSql,
+                                   sqlite3_stmt **statement,
+                                   StatementOrigin *origin) {
+  if (*statement != nullptr && **statementSql != command.sql) {
+    release_statement(db, **statementSql, *statement, *origin);
+    *statement = nullptr;
+  }
+
+  if (*statement == nullptr) {
+    const char *remainingStatement = nullptr;
+    int status = acquire_statement(db, command.sql, &remainingStatement,
+                                   statement, origin);
+
+    if (status != SQLITE_OK) {
+      *statement = nullptr;
+      return {.type = SQLiteError,
+              .message = "[op-sqlite] SQL statement error on "
+                         "opsqlite_execute_batch:\n" +
+                         std::to_string(status) + " description:\n" +
+                         std::string(sqlite3_errmsg(db))};
+    }
+
+    // Several statements in one command, or nothing to run at all, are left
+    // to the normal execution path. Cached statements are always single ones
+    if (*statement == nullptr ||
+        (remainingStatement != nullptr && !is_blank(remainingStatement))) {
+      if (*statement != nullptr) {
+        sqlite3_finalize(*statement);
+        *statement = nullptr;
+      }
+
+      return execute_on(db, command.sql, command.params.get(), nullptr,
+                        nullptr);
+    }
+
+    *statementSql = &command.sql;
+  }
+
+  if (command.params != nullptr && !command.params->empty()) {
+    bind_values(*statement, command.params.get(), SQLITE_STATIC);
+  }
+
+  int result;
+  do {
+    result = sqlite3_step(*statement);
+  } while (result == SQLITE_ROW);
+
+  std::string errorMessage;
+  if (result != SQLITE_DONE) {
+    errorMessage = sqlite3_errmsg(db);
+  }
+
+  sqlite3_reset(*statement);
+  sqlite3_clear_bindings(*statement);
+
+  if (result != SQLITE_DONE) {
+    return {.type = SQLiteError,
+            .message = "[op-sqlite] SQLite error code: " +
+                       std::to_string(result) +
+                       ", description: " + errorMessage};
+  }
+
+  return {.type = SQLiteOk, .affectedRows = sqlite3_changes(db)};
+}
+
 BatchResult opsqlite_execute_batch(std::string dbName,
-                                   std::vector<BatchArguments> *commands) {
+                                   std::vector<BatchArguments> *commands,
+                                   BatchOptions const &options) {
   size_t commandCount = commands->size();
   if (commandCount <= 0) {
     return BatchResult{
@@ -894,39 +1789,100 @@ BatchResult opsqlite_execute_batch(std::string dbName,
     };
   }
 
-  try {
-    int affectedRows = 0;
-    opsqlite_execute(dbName, "BEGIN EXCLUSIVE TRANSACTION", nullptr, nullptr,
-                     nullptr);
-    for (int i = 0; i < commandCount; i++) {
-      auto command = commands->at(i);
-      // We do not provide a datastructure to receive query data because we
-      // don't need/want to handle this results in a batch execution
-      auto result = opsqlite_execute(dbName, command.sql, command.params.get(),
-                                     nullptr, nullptr);
-      if (result.type == SQLiteError) {
-        opsqlite_execute(dbName, "ROLLBACK", nullptr, nullptr, nullptr);
-        return BatchResult{
-            .type = SQLiteError,
-            .message = result.message,
-        };
-      } else {
-        affectedRows += result.affectedRows;
+  if (dbMap.count(dbName) == 0) {
+    return BatchResult{
+        .type = SQLiteError,
+        .message = "[OP-SQLite] DB is not open",
+    };
+  }
+
+  ConnectionOwnership ownership(dbName);
+  sqlite3 *db = dbMap[dbName];
+
+  // Inside a transaction that is already open the batch can only be undone
+  // through a savepoint, and it cannot be committed in chunks. Savepoints of
+  // native transactions are numbered from 1, so 0 never clashes with them
+  bool nested = !sqlite3_get_autocommit(db);
+  const int savepoint = 0;
+
+  BridgeResult begin =
+      nested ? opsqlite_transaction_command(dbName, SavepointCommand, savepoint)
+             : opsqlite_transaction_command(dbName, options.begin);
+
+  if (begin.type == SQLiteError) {
+    return BatchResult{
+        .type = SQLiteError,
+        .message = begin.message,
+    };
+  }
+
+  const std::string *statementSql = nullptr;
+  sqlite3_stmt *statement = nullptr;
+  StatementOrigin origin;
+  int affectedRows = 0;
+  BridgeResult failure = {.type = SQLiteOk};
+
+  for (size_t i = 0; i < commandCount; i++) {
+    auto result = execute_batch_command(db, commands->at(i), &statementSql,
+                                        &statement, &origin);
+
+    if (result.type == SQLiteError) {
+      failure = result;
+      break;
+    }
+
+    affectedRows += result.affectedRows;
+
+    if (!nested && options.chunk_size > 0 && (i + 1) % options.chunk_size == 0 &&
+        i + 1 < commandCount) {
+      failure = opsqlite_transaction_command(dbName, CommitCommand);
+      if (failure.type == SQLiteOk) {
+        failure = opsqlite_transaction_command(dbName, options.begin);
       }
+      if (failure.type == SQLiteError) {
+        break;
+      }
+    }
+  }
+
+  if (statement != nullptr) {
+    release_statement(db, *statementSql, statement, origin);
+  }
+
+  if (failure.type == SQLiteError) {
+    if (nested) {
+      opsqlite_transaction_command(dbName, RollbackToCommand, savepoint);
+      opsqlite_transaction_command(dbName, ReleaseCommand, savepoint);
+    } else if (!sqlite3_get_autocommit(db)) {
+      opsqlite_transaction_command(dbName, RollbackCommand);
     }
-    opsqlite_execute(dbName, "COMMIT", nullptr, nullptr, nullptr);
+
     return BatchResult{
-        .type = SQLiteOk,
-        .affectedRows = affectedRows,
-        .commands = static_cast<int>(commandCount),
+        .type = SQLiteError,
+        .message = failure.message,
     };
-  } catch (std::exception &exc) {
-    opsqlite_execute(dbName, "ROLLBACK", nullptr, nullptr, nullptr);
+  }
+
+  BridgeResult end =
+      nested ? opsqlite_transaction_command(dbName, ReleaseCommand, savepoint)
+             : opsqlite_transaction_command(dbName, CommitCommand);
+
+  if (end.type == SQLiteError) {
+    if (!nested) {
+      opsqlite_transaction_command(dbName, RollbackCommand);
+    }
+
     return BatchResult{
         .type = SQLiteError,
-        .message = exc.what(),
+        .message = end.message,
     };
   }
+
+  return BatchResult{
+      .type = SQLiteOk,
+      .affectedRows = affectedRows,
+      .commands = static_cast<int>(commandCount),
+  };
 }
 
 } // namespace opsqlite
@@ -1,8 +1,10 @@
 #ifndef bridge_h
 #define bridge_h
 
-#include "DumbHostObject.h"
+#include "ResultBuffer.h"
+#include "ResultCache.h"
 #include "SmartHostObject.h"
+#include "StatementCache.h"
 #include "sqlite3.h"
 #include "types.h"
 #include "utils.h"
@@ -19,20 +21,56 @@ typedef std::function<void(std::string dbName, std::string tableName,
 typedef std::function<void(std::string dbName)> CommitCallback;
 typedef std::function<void(std::string dbName)> RollbackCallback;
 
+enum TransactionCommand {
+  BeginCommand,
+  BeginImmediateCommand,
+  BeginExclusiveCommand,
+  CommitCommand,
+  RollbackCommand,
+  SavepointCommand,
+  ReleaseCommand,
+  RollbackToCommand
+};
+
+struct BatchOptions {
+  // How the transaction wrapping the batch is started
+  TransactionCommand begin = BeginImmediateCommand;
+  // Commits every that many commands when not 0, so the journal of a big
+  // batch does not grow without bound. Commands of chunks that were already
+  // committed are not rolled back if a later one fails
+  size_t chunk_size = 0;
+};
+
 std::string opsqlite_get_db_path(std::string const &db_name,
                                  std::string const &location);
 
+/// With owned_connection the connection is opened with SQLITE_OPEN_NOMUTEX,
+/// the bridge calls on it take turns holding it for their whole duration
 #ifdef OP_SQLITE_USE_SQLCIPHER
 BridgeResult opsqlite_open(std::string const &dbName, std::string const &dbPath,
                            std::string const &crsqlite_path,
                            std::string const &sqlite_vec_path,
-                           std::string const &encryptionKey);
+                           std::string const &encryptionKey,
+                           bool owned_connection = false);
 #else
 BridgeResult opsqlite_open(std::string const &dbName, std::string const &dbPath,
                            std::string const &crsqlite_path,
-                           std::string const &sqlite_vec_path);
+                           std::string const &sqlite_vec_path,
+                           bool owned_connection = false);
+#endif
+
+#ifdef OP_SQLITE_USE_SQLCIPHER
+BridgeResult opsqlite_open_readers(std::string const &dbName,
+                                   std::string const &dbPath, int count,
+                                   std::string const &encryptionKey);
+#else
+BridgeResult opsqlite_open_readers(std::string const &dbName,
+                                   std::string const &dbPath, int count);
 #endif
 
+bool opsqlite_should_use_reader(std::string const &dbName,
+                                std::string const &query);
+
 BridgeResult opsqlite_close(std::string const &dbName);
 
 BridgeResult opsqlite_remove(std::string const &dbName,
@@ -49,17 +87,36 @@ BridgeResult opsqlite_detach(std::string const &mainDBName,
 BridgeResult
 opsqlite_execute(std::string const &dbName, std::string const &query,
                  const std::vector<JSVariant> *params,
-                 std::vector<DumbHostObject> *results,
-                 std::shared_ptr<std::vector<SmartHostObject>> metadatas);
+                 ResultBuffer *results,
+                 std::shared_ptr<std::vector<SmartHostObject>> metadatas,
+                 CancellationToken const *cancellation = nullptr);
 
 BatchResult opsqlite_execute_batch(std::string dbName,
-                                   std::vector<BatchArguments> *commands);
+                                   std::vector<BatchArguments> *commands,
+                                   BatchOptions const &options = {});
+
+BatchResult opsqlite_insert_columns(std::string const &dbName,
+                                    std::string const &table,
+                                    std::vector<ColumnValues> const &columns,
+                                    size_t rows);
 
 BridgeResult opsqlite_execute_raw(std::string const &dbName,
                                   std::string const &query,
                                   const std::vector<JSVariant> *params,
                                   std::vector<std::vector<JSVariant>> *results);
 
+BridgeResult
+opsqlite_execute_read(std::string const &dbName, std::string const &query,
+                      const std::vector<JSVariant> *params,
+                      ResultBuffer *results,
+                      std::shared_ptr<std::vector<SmartHostObject>> metadatas,
+                      CancellationToken const *cancellation = nullptr);
+
+BridgeResult
+opsqlite_execute_raw_read(std::string const &dbName, std::string const &query,
+                          const std::vector<JSVariant> *params,
+                          std::vector<std::vector<JSVariant>> *results);
+
 void opsqlite_close_all();
 
 BridgeResult opsqlite_register_update_hook(std::string const &dbName,
@@ -75,14 +132,51 @@ BridgeResult opsqlite_deregister_rollback_hook(std::string const &dbName);
 sqlite3_stmt *opsqlite_prepare_statement(std::string const &dbName,
                                          std::string const &query);
 
-void opsqlite_bind_statement(sqlite3_stmt *statement,
+void opsqlite_bind_statement(std::string const &dbName,
+                             sqlite3_stmt *statement,
                              const std::vector<JSVariant> *params);
 
+void opsqlite_finalize_statement(std::string const &dbName,
+                                 sqlite3_stmt *statement);
+
 BridgeResult opsqlite_execute_prepared_statement(
     std::string const &dbName, sqlite3_stmt *statement,
-    std::vector<DumbHostObject> *results,
+    ResultBuffer *results,
     std::shared_ptr<std::vector<SmartHostObject>> metadatas);
 
+BridgeResult opsqlite_step_statement(std::string const &dbName,
+                                     sqlite3_stmt *statement, size_t max_rows,
+                                     ResultBuffer *results, bool *done);
+
+BridgeResult opsqlite_transaction_command(std::string const &dbName,
+                                          TransactionCommand command,
+                                          int savepoint = 0);
+
+bool opsqlite_in_transaction(std::string const &dbName);
+
+bool opsqlite_is_owned_connection(std::string const &dbName);
+
+StatementCacheStats
+opsqlite_get_statement_cache_stats(std::string const &dbName);
+
+/// A max_entries of 0 turns the result cache off and drops its entries
+void opsqlite_set_result_cache(std::string const &dbName,
+                               ResultCacheOptions const &options);
+
+ResultCacheStats opsqlite_get_result_cache_stats(std::string const &dbName);
+
+/// Looks a query up in the result cache, key is its query_key
+bool opsqlite_cached_result(std::string const &dbName, std::string const &key,
+                            CachedResult *result);
+
+BridgeResult
+opsqlite_execute_cached(std::string const &dbName, std::string const &query,
+                        const std::vector<JSVariant> *params,
+                        std::string const &key, bool use_reader,
+                        std::shared_ptr<ResultBuffer> results,
+                        std::shared_ptr<std::vector<SmartHostObject>> metadatas,
+                        CancellationToken const *cancellation = nullptr);
+
 BridgeResult opsqlite_load_extension(std::string const &db_name,
                                      std::string &path,
                                      std::string &entry_point);
@@ -1,5 +1,6 @@
 #include "bridge.h"
-#include "DumbHostObject.h"
+#include "ResultBuffer.h"
+#include "RowSink.h"
 #include "SmartHostObject.h"
 #include "logs.h"
 #include "utils.h"
@@ -246,6 +247,142 @@ BridgeResult opsqlite_libsql_remove(std::string const &name,
   };
 }
 
+/// The first statement that returns rows decides the columns of the result
+inline std::vector<std::string> column_names(libsql_rows_t rows,
+                                             int num_cols) {
+  std::vector<std::string> names;
+  names.reserve(num_cols);
+
+  for (int col = 0; col < num_cols; col++) {
+    const char *col_name;
+    const char *err = NULL;
+    libsql_column_name(rows, col, &col_name, &err);
+    names.emplace_back(col_name);
+  }
+
+  return names;
+}
+
+template <typename Sink>
+inline int decode_value(libsql_row_t row, int col, int type, Sink &sink,
+                        const char **err) {
+  int status = 0;
+
+  switch (type) {
+  case LIBSQL_INT:
+    long long int_value;
+    status = libsql_get_int(row, col, &int_value, err);
+    sink.add_integer(int_value);
+    break;
+
+  case LIBSQL_FLOAT:
+    double float_value;
+    status = libsql_get_float(row, col, &float_value, err);
+    sink.add_double(float_value);
+    break;
+
+  case LIBSQL_TEXT:
+    const char *text_value;
+    status = libsql_get_string(row, col, &text_value, err);
+    sink.add_text(text_value, strlen(text_value));
+    break;
+
+  case LIBSQL_BLOB: {
+    blob value_blob;
+    libsql_get_blob(row, col, &value_blob, err);
+    sink.add_blob(value_blob.ptr, value_blob.len);
+    libsql_free_blob(value_blob);
+    break;
+  }
+
+  case LIBSQL_NULL:
+    // intentional fall-through
+  default:
+    sink.add_null();
+    break;
+  }
+
+  return status;
+}
+
+/// Reads the rows of a query into the sink, see RowSink.h. The metadata is
+/// taken from the first row
+template <typename Sink>
+void read_rows(libsql_rows_t rows, Sink &sink,
+               std::vector<SmartHostObject> *metadatas) {
+  libsql_row_t row;
+  int status = 0;
+  const char *err = NULL;
+  bool metadata_set = false;
+
+  int num_cols = libsql_column_count(rows);
+  while (!sink.full() && (status = libsql_next_row(rows, &row, &err)) == 0) {
+
+    if (!err && !row) {
+      break;
+    }
+
+    size_t decoded = 0;
+
+    if constexpr (Sink::decodes) {
+      if (sink.needs_columns()) {
+        sink.set_columns(column_names(rows, num_cols));
+      }
+
+      size_t width = std::min(static_cast<size_t>(num_cols), sink.width());
+      for (; decoded < width; decoded++) {
+        int col = static_cast<int>(decoded);
+        int type;
+
+        libsql_column_type(rows, row, col, &type, &err);
+        status = decode_value(row, col, type, sink, &err);
+
+        if (status != 0) {
+          fprintf(stderr, "%s\n", err);
+          throw std::runtime_error("libsql error");
+        }
+      }
+    }
+
+    sink.end_row(decoded);
+
+    // On the first row, set the metadata
+    if (!metadata_set && metadatas != nullptr) {
+      for (int col = 0; col < num_cols; col++) {
+        const char *col_name;
+        libsql_column_name(rows, col, &col_name, &err);
+
+        auto metadata = SmartHostObject();
+        metadata.fields.push_back(std::make_pair("name", col_name));
+        metadata.fields.push_back(std::make_pair("index", col));
+        metadata.fields.push_back(std::make_pair("type", "UNKNOWN"));
+
+        metadatas->push_back(metadata);
+      }
+    }
+
+    metadata_set = true;
+    err = NULL;
+  }
+
+  if (status != 0) {
+    fprintf(stderr, "%s\n", err);
+  }
+}
+
+/// Reads into a ResultBuffer, or only steps through the rows without one
+inline void read_rows(libsql_rows_t rows, ResultBuffer *results,
+                      std::vector<SmartHostObject> *metadatas) {
+  if (results == nullptr) {
+    DiscardSink sink;
+    read_rows(rows, sink, metadatas);
+    return;
+  }
+
+  ResultBufferSink sink(results);
+  read_rows(rows, sink, metadatas);
+}
+
 void opsqlite_libsql_bind_statement(libsql_stmt_t statement,
                                     const std::vector<JSVariant> *values) {
   const char *err;
@@ -256,7 +393,7 @@ void opsqlite_libsql_bind_statement(libsql_stmt_t statement,
     JSVariant value = values->at(ii);
 
     if (std::holds_alternative<bool>(value)) {
-      libsql_bind_int(statement, index, std::get<int>(value), &err);
+      libsql_bind_int(statement, index, std::get<bool>(value), &err);
     } else if (std::holds_alternative<int>(value)) {
       libsql_bind_int(statement, index, std::get<int>(value), &err);
     } else if (std::holds_alternative<long long>(value)) {
@@ -277,14 +414,13 @@ void opsqlite_libsql_bind_statement(libsql_stmt_t statement,
 
 BridgeResult opsqlite_libsql_execute_prepared_statement(
     std::string const &name, libsql_stmt_t stmt,
-    std::vector<DumbHostObject> *results,
+    ResultBuffer *results,
     std::shared_ptr<std::vector<SmartHostObject>> metadatas) {
 
   check_db_open(name);
 
   libsql_connection_t c = db_map[name].c;
   libsql_rows_t rows;
-  libsql_row_t row;
 
   int status = 0;
   const char *err = NULL;
@@ -299,95 +435,7 @@ BridgeResult opsqlite_libsql_execute_prepared_statement(
     return {.type = SQLiteError, .message = err};
   }
 
-  bool metadata_set = false;
-
-  int num_cols = libsql_column_count(rows);
-  while ((status = libsql_next_row(rows, &row, &err)) == 0) {
-
-    if (!err && !row) {
-      break;
-    }
-
-    DumbHostObject row_host_object = DumbHostObject(metadatas);
-
-    for (int col = 0; col < num_cols; col++) {
-      int type;
-
-      libsql_column_type(rows, row, col, &type, &err);
-
-      switch (type) {
-      case LIBSQL_INT:
-        long long int_value;
-        status = libsql_get_int(row, col, &int_value, &err);
-        row_host_object.values.push_back(JSVariant(int_value));
-        break;
-
-      case LIBSQL_FLOAT:
-        double float_value;
-        status = libsql_get_float(row, col, &float_value, &err);
-        row_host_object.values.push_back(JSVariant(float_value));
-        break;
-
-      case LIBSQL_TEXT:
-        const char *text_value;
-        status = libsql_get_string(row, col, &text_value, &err);
-        row_host_object.values.push_back(JSVariant(text_value));
-        break;
-
-      case LIBSQL_BLOB: {
-        blob value_blob;
-        libsql_get_blob(row, col, &value_blob, &err);
-        uint8_t *data = new uint8_t[value_blob.len];
-        // You cannot share raw memory between native and JS
-        // always copy the data
-        memcpy(data, value_blob.ptr, value_blob.len);
-        libsql_free_blob(value_blob);
-        row_host_object.values.push_back(JSVariant(
-            ArrayBuffer{.data = std::shared_ptr<uint8_t>{data},
-                        .size = static_cast<size_t>(value_blob.len)}));
-        break;
-      }
-
-      case LIBSQL_NULL:
-        // intentional fall-through
-      default:
-        row_host_object.values.push_back(JSVariant(nullptr));
-        break;
-      }
-
-      if (status != 0) {
-        fprintf(stderr, "%s\n", err);
-        throw std::runtime_error("libsql error");
-      }
-
-      // On the first interation through the columns, set the metadata
-      if (!metadata_set && metadatas != nullptr) {
-        const char *col_name;
-        status = libsql_column_name(rows, col, &col_name, &err);
-
-        auto metadata = SmartHostObject();
-        metadata.fields.push_back(std::make_pair("name", col_name));
-        metadata.fields.push_back(std::make_pair("index", col));
-        metadata.fields.push_back(std::make_pair("type", "UNKNOWN"));
-        //                  metadata.fields.push_back(
-        //                      std::make_pair("type", type == -1 ? "UNKNOWN" :
-        //                      type));
-
-        metadatas->push_back(metadata);
-      }
-    }
-
-    if (results != nullptr) {
-      results->push_back(row_host_object);
-    }
-
-    metadata_set = true;
-    err = NULL;
-  }
-
-  if (status != 0) {
-    fprintf(stderr, "%s\n", err);
-  }
+  read_rows(rows, results, metadatas.get());
 
   libsql_free_rows(rows);
 
@@ -423,14 +471,13 @@ libsql_stmt_t opsqlite_libsql_prepare_statement(std::string const &name,
 /// Base execution function, returns HostObjects to the JS environment
 BridgeResult opsqlite_libsql_execute(
     std::string const &name, std::string const &query,
-    const std::vector<JSVariant> *params, std::vector<DumbHostObject> *results,
+    const std::vector<JSVariant> *params, ResultBuffer *results,
     std::shared_ptr<std::vector<SmartHostObject>> metadatas) {
 
   check_db_open(name);
 
   libsql_connection_t c = db_map[name].c;
   libsql_rows_t rows;
-  libsql_row_t row;
   libsql_stmt_t stmt;
   int status = 0;
   const char *err = NULL;
@@ -451,95 +498,7 @@ BridgeResult opsqlite_libsql_execute(
     return {.type = SQLiteError, .message = err};
   }
 
-  bool metadata_set = false;
-
-  int num_cols = libsql_column_count(rows);
-  while ((status = libsql_next_row(rows, &row, &err)) == 0) {
-
-    if (!err && !row) {
-      break;
-    }
-
-    DumbHostObject row_host_object = DumbHostObject(metadatas);
-
-    for (int col = 0; col < num_cols; col++) {
-      int type;
-
-      libsql_column_type(rows, row, col, &type, &err);
-
-      switch (type) {
-      case LIBSQL_INT:
-        long long int_value;
-        status = libsql_get_int(row, col, &int_value, &err);
-        row_host_object.values.push_back(JSVariant(int_value));
-        break;
-
-      case LIBSQL_FLOAT:
-        double float_value;
-        status = libsql_get_float(row, col, &float_value, &err);
-        row_host_object.values.push_back(JSVariant(float_value));
-        break;
-
-      case LIBSQL_TEXT:
-        const char *text_value;
-        status = libsql_get_string(row, col, &text_value, &err);
-        row_host_object.values.push_back(JSVariant(text_value));
-        break;
-
-      case LIBSQL_BLOB: {
-        blob value_blob;
-        libsql_get_blob(row, col, &value_blob, &err);
-        uint8_t *data = new uint8_t[value_blob.len];
-        // You cannot share raw memory between native and JS
-        // always copy the data
-        memcpy(data, value_blob.ptr, value_blob.len);
-        libsql_free_blob(value_blob);
-        row_host_object.values.push_back(JSVariant(
-            ArrayBuffer{.data = std::shared_ptr<uint8_t>{data},
-                        .size = static_cast<size_t>(value_blob.len)}));
-        break;
-      }
-
-      case LIBSQL_NULL:
-        // intentional fall-through
-      default:
-        row_host_object.values.push_back(JSVariant(nullptr));
-        break;
-      }
-
-      if (status != 0) {
-        fprintf(stderr, "%s\n", err);
-        throw std::runtime_error("libsql error");
-      }
-
-      // On the first interation through the columns, set the metadata
-      if (!metadata_set && metadatas != nullptr) {
-        const char *col_name;
-        status = libsql_column_name(rows, col, &col_name, &err);
-
-        auto metadata = SmartHostObject();
-        metadata.fields.push_back(std::make_pair("name", col_name));
-        metadata.fields.push_back(std::make_pair("index", col));
-        metadata.fields.push_back(std::make_pair("type", "UNKNOWN"));
-        //                  metadata.fields.push_back(
-        //                      std::make_pair("type", type == -1 ? "UNKNOWN" :
-        //                      type));
-
-        metadatas->push_back(metadata);
-      }
-    }
-
-    if (results != nullptr) {
-      results->push_back(row_host_object);
-    }
-
-    metadata_set = true;
-    err = NULL;
-  }
-
-  if (status != 0) {
-    fprintf(stderr, "%s\n", err);
-  }
+  read_rows(rows, results, metadatas.get());
 
   libsql_free_rows(rows);
   libsql_free_stmt(stmt);
@@ -563,7 +522,6 @@ opsqlite_libsql_execute_raw(std::string const &name, std::string const &query,
 
   libsql_connection_t c = db_map[name].c;
   libsql_rows_t rows;
-  libsql_row_t row;
   libsql_stmt_t stmt;
   int status = 0;
   const char *err = NULL;
@@ -584,75 +542,12 @@ opsqlite_libsql_execute_raw(std::string const &name, std::string const &query,
     return {.type = SQLiteError, .message = err};
   }
 
-  int num_cols = libsql_column_count(rows);
-  while ((status = libsql_next_row(rows, &row, &err)) == 0) {
-
-    if (!err && !row) {
-      break;
-    }
-
-    std::vector<JSVariant> row_vector;
-
-    for (int col = 0; col < num_cols; col++) {
-      int type;
-
-      libsql_column_type(rows, row, col, &type, &err);
-
-      switch (type) {
-      case LIBSQL_INT:
-        long long int_value;
-        status = libsql_get_int(row, col, &int_value, &err);
-        row_vector.push_back(JSVariant(int_value));
-        break;
-
-      case LIBSQL_FLOAT:
-        double float_value;
-        status = libsql_get_float(row, col, &float_value, &err);
-        row_vector.push_back(JSVariant(float_value));
-        break;
-
-      case LIBSQL_TEXT:
-        const char *text_value;
-        status = libsql_get_string(row, col, &text_value, &err);
-        row_vector.push_back(JSVariant(text_value));
-        break;
-
-      case LIBSQL_BLOB: {
-        blob value_blob;
-        libsql_get_blob(row, col, &value_blob, &err);
-        uint8_t *data = new uint8_t[value_blob.len];
-        // You cannot share raw memory between native and JS
-        // always copy the data
-        memcpy(data, value_blob.ptr, value_blob.len);
-        libsql_free_blob(value_blob);
-        row_vector.push_back(JSVariant(
-            ArrayBuffer{.data = std::shared_ptr<uint8_t>{data},
-                        .size = static_cast<size_t>(value_blob.len)}));
-        break;
-      }
-
-      case LIBSQL_NULL:
-        // intentional fall-through
-      default:
-        row_vector.push_back(JSVariant(nullptr));
-        break;
-      }
-
-      if (status != 0) {
-        fprintf(stderr, "%s\n", err);
-        throw std::runtime_error("libsql error");
-      }
-    }
-
-    if (results != nullptr) {
-      results->push_back(row_vector);
-    }
-
-    err = NULL;
-  }
-
-  if (status != 0) {
-    fprintf(stderr, "%s\n", err);
+  if (results == nullptr) {
+    DiscardSink sink;
+    read_rows(rows, sink, nullptr);
+  } else {
+    VariantRowsSink sink(results);
+    read_rows(rows, sink, nullptr);
   }
 
   libsql_free_rows(rows);
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "DumbHostObject.h"
+#include "ResultBuffer.h"
 #include "SmartHostObject.h"
 #include "libsql.h"
 #include "types.h"
@@ -57,7 +57,7 @@ BridgeResult opsqlite_libsql_sync(std::string const &name);
 
 BridgeResult opsqlite_libsql_execute(
     std::string const &name, std::string const &query,
-    const std::vector<JSVariant> *params, std::vector<DumbHostObject> *results,
+    const std::vector<JSVariant> *params, ResultBuffer *results,
     std::shared_ptr<std::vector<SmartHostObject>> metadatas);
 
 BridgeResult
@@ -78,8 +78,7 @@ void opsqlite_libsql_bind_statement(libsql_stmt_t stmt,
                                     const std::vector<JSVariant> *params);
 
 BridgeResult opsqlite_libsql_execute_prepared_statement(
-    std::string const &name, libsql_stmt_t stmt,
-    std::vector<DumbHostObject> *results,
+    std::string const &name, libsql_stmt_t stmt, ResultBuffer *results,
     std::shared_ptr<std::vector<SmartHostObject>> metadatas);
 
 } // namespace opsqlite
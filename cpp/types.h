@@ -1,6 +1,8 @@
 #ifndef types_h
 #define types_h
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <variant>
@@ -21,6 +23,25 @@ struct BatchResult {
   int commands;
 };
 
+/// Stops a query that is no longer wanted. Cancelled from the JS thread, the
+/// worker checks it before running the query and while stepping it
+struct CancellationToken {
+  std::atomic<bool> cancelled{false};
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::time_point::max();
+
+  bool should_stop() const {
+    return cancelled ||
+           (deadline != std::chrono::steady_clock::time_point::max() &&
+            std::chrono::steady_clock::now() >= deadline);
+  }
+
+  std::string reason() const {
+    return cancelled ? "[op-sqlite] Query was cancelled"
+                     : "[op-sqlite] Query timed out";
+  }
+};
+
 struct ArrayBuffer {
   std::shared_ptr<uint8_t> data;
   size_t size;
@@ -34,4 +55,18 @@ struct BatchArguments {
   std::shared_ptr<std::vector<JSVariant>> params;
 };
 
+enum ColumnType { Float64Column, Int32Column, TextColumn };
+
+/// Values of one column for insertColumns
+struct ColumnValues {
+  std::string name;
+  ColumnType type;
+  // Float64Column and Int32Column values, borrowed from the typed array or
+  // kept alive by owner
+  const void *numbers;
+  std::shared_ptr<uint8_t> owner;
+  // TextColumn values, strings or nulls
+  std::vector<JSVariant> texts;
+};
+
 #endif /* types_h */
@@ -1,11 +1,15 @@
 #include "utils.h"
+#include "LazyRowsHostObject.h"
 #include "SmartHostObject.h"
 #ifndef OP_SQLITE_USE_LIBSQL
 #include "bridge.h"
 #endif
+#include <climits>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <strings.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -27,34 +31,50 @@ jsi::Value toJSI(jsi::Runtime &rt, JSVariant value) {
     return jsi::String::createFromUtf8(rt, str);
   } else if (std::holds_alternative<ArrayBuffer>(value)) {
     auto jsBuffer = std::get<ArrayBuffer>(value);
-    jsi::Function array_buffer_ctor =
-        rt.global().getPropertyAsFunction(rt, "ArrayBuffer");
-    jsi::Object o = array_buffer_ctor.callAsConstructor(rt, (int)jsBuffer.size)
-                        .getObject(rt);
-    jsi::ArrayBuffer buf = o.getArrayBuffer(rt);
-    memcpy(buf.data(rt), jsBuffer.data.get(), jsBuffer.size);
-    return o;
+    return jsi::ArrayBuffer(
+        rt, std::make_shared<SharedBuffer>(jsBuffer.data, jsBuffer.size));
   }
 
   return jsi::Value::null();
 }
 
+/// Whole numbers are bound as integers, the range checks keep the casts
+/// defined for NaN, infinities and numbers beyond 64 bits
+static JSVariant number_to_variant(double value) {
+  if (value >= INT_MIN && value <= INT_MAX &&
+      static_cast<int>(value) == value) {
+    return JSVariant(static_cast<int>(value));
+  }
+
+  if (value >= -9223372036854775808.0 && value < 9223372036854775808.0 &&
+      static_cast<long long>(value) == value) {
+    return JSVariant(static_cast<long long>(value));
+  }
+
+  return JSVariant(value);
+}
+
+/// BigInts are bound as 64 bit integers, larger ones are rejected
+static JSVariant big_int_to_variant(jsi::Runtime &rt, const jsi::Value &value) {
+  auto big_int = value.getBigInt(rt);
+
+  if (!big_int.isInt64(rt)) {
+    throw std::invalid_argument(
+        "[op-sqlite] BigInt parameters must fit in a signed 64 bit integer");
+  }
+
+  return JSVariant(static_cast<long long>(big_int.getInt64(rt)));
+}
+
 JSVariant toVariant(jsi::Runtime &rt, const jsi::Value &value) {
   if (value.isNull() || value.isUndefined()) {
     return JSVariant(nullptr);
   } else if (value.isBool()) {
     return JSVariant(value.getBool());
   } else if (value.isNumber()) {
-    double doubleVal = value.asNumber();
-    int intVal = (int)doubleVal;
-    long long longVal = (long)doubleVal;
-    if (intVal == doubleVal) {
-      return JSVariant(intVal);
-    } else if (longVal == doubleVal) {
-      return JSVariant(longVal);
-    } else {
-      return JSVariant(doubleVal);
-    }
+    return number_to_variant(value.asNumber());
+  } else if (value.isBigInt()) {
+    return big_int_to_variant(rt, value);
   } else if (value.isString()) {
     std::string strVal = value.asString(rt).utf8(rt);
     return JSVariant(strVal);
@@ -69,11 +89,7 @@ JSVariant toVariant(jsi::Runtime &rt, const jsi::Value &value) {
     }
 
     auto buffer = obj.getArrayBuffer(rt);
-    uint8_t *data = new uint8_t[buffer.size(rt)];
-    memcpy(data, buffer.data(rt), buffer.size(rt));
-
-    return JSVariant(ArrayBuffer{.data = std::shared_ptr<uint8_t>{data},
-                                 .size = buffer.size(rt)});
+    return JSVariant(copy_array_buffer(buffer.data(rt), buffer.size(rt)));
 
   } else {
     throw std::invalid_argument(
@@ -81,6 +97,118 @@ JSVariant toVariant(jsi::Runtime &rt, const jsi::Value &value) {
   }
 }
 
+ArrayBuffer copy_array_buffer(const void *data, size_t size) {
+  uint8_t *copy = new uint8_t[size];
+  memcpy(copy, data, size);
+
+  return {.data = std::shared_ptr<uint8_t>(copy,
+                                          std::default_delete<uint8_t[]>()),
+          .size = size};
+}
+
+bool is_single_select(std::string const &query) {
+  const char *sql = query.c_str();
+  while (isspace(static_cast<unsigned char>(*sql))) {
+    sql++;
+  }
+
+  if (strncasecmp(sql, "SELECT", 6) != 0 ||
+      isalnum(static_cast<unsigned char>(sql[6]))) {
+    return false;
+  }
+
+  // Several statements in one query are left alone, a trailing semicolon is
+  // fine
+  const char *separator = strchr(sql, ';');
+  if (separator == nullptr) {
+    return true;
+  }
+
+  separator++;
+  while (isspace(static_cast<unsigned char>(*separator))) {
+    separator++;
+  }
+  return *separator == '\0';
+}
+
+std::string query_key(std::string const &query,
+                      std::vector<JSVariant> const &params, bool big_ints) {
+  std::string key;
+  key.reserve(query.size() + params.size() * 8 + 1);
+  key.push_back(big_ints ? 'b' : 'n');
+
+  // Quoted strings and identifiers are copied as they are
+  char quote = 0;
+  bool space = false;
+  for (size_t i = 0; i < query.size(); i++) {
+    char c = query[i];
+    if (quote != 0) {
+      key.push_back(c);
+      if (c == quote) {
+        quote = 0;
+      }
+      continue;
+    }
+
+    if (isspace(static_cast<unsigned char>(c))) {
+      space = true;
+      continue;
+    }
+
+    if (space && key.size() > 1) {
+      key.push_back(' ');
+    }
+    space = false;
+
+    // A line break ends a -- comment, from the first comment on the rest is
+    // copied as it is so statements that differ in it never share a key
+    char next = i + 1 < query.size() ? query[i + 1] : '\0';
+    if ((c == '-' && next == '-') || (c == '/' && next == '*')) {
+      key.append(query, i, std::string::npos);
+      break;
+    }
+
+    if (c == '\'' || c == '"' || c == '`') {
+      quote = c;
+    } else if (c == '[') {
+      quote = ']';
+    }
+    key.push_back(c);
+  }
+
+  // Every value is tagged with its type and strings with their size, so no
+  // two parameter lists give the same key
+  key.push_back('\0');
+  for (auto const &param : params) {
+    key.push_back(static_cast<char>('0' + param.index()));
+
+    if (auto b = std::get_if<bool>(&param)) {
+      key.push_back(*b ? '1' : '0');
+    } else if (auto i = std::get_if<int>(&param)) {
+      key += std::to_string(*i);
+    } else if (auto l = std::get_if<long>(&param)) {
+      key += std::to_string(*l);
+    } else if (auto ll = std::get_if<long long>(&param)) {
+      key += std::to_string(*ll);
+    } else if (auto d = std::get_if<double>(&param)) {
+      key.append(reinterpret_cast<const char *>(d), sizeof(double));
+    } else if (auto s = std::get_if<std::string>(&param)) {
+      key += std::to_string(s->size());
+      key.push_back(':');
+      key += *s;
+    } else if (auto buffer = std::get_if<ArrayBuffer>(&param)) {
+      key += std::to_string(buffer->size);
+      key.push_back(':');
+      key.append(reinterpret_cast<const char *>(buffer->data.get()),
+                 buffer->size);
+    }
+
+    key.push_back('\0');
+  }
+
+  return key;
+}
+
 std::vector<std::string> to_string_vec(jsi::Runtime &rt, jsi::Value const &xs) {
   jsi::Array values = xs.asObject(rt).asArray(rt);
   std::vector<std::string> res;
@@ -101,7 +229,11 @@ std::vector<int> to_int_vec(jsi::Runtime &rt, jsi::Value const &xs) {
   return res;
 }
 
-std::vector<JSVariant> to_variant_vec(jsi::Runtime &rt, jsi::Value const &xs) {
+/// With borrow_buffers ArrayBuffers point to the JS memory instead of being
+/// copied, only valid while the JS values are alive and the JS thread is
+/// blocked, i.e. for the duration of a synchronous call
+std::vector<JSVariant> to_variant_vec(jsi::Runtime &rt, jsi::Value const &xs,
+                                      bool borrow_buffers) {
   std::vector<JSVariant> res;
 
   if (xs.isNull() || xs.isUndefined()) {
@@ -118,16 +250,9 @@ std::vector<JSVariant> to_variant_vec(jsi::Runtime &rt, jsi::Value const &xs) {
     } else if (value.isBool()) {
       res.push_back(JSVariant(value.getBool()));
     } else if (value.isNumber()) {
-      double doubleVal = value.asNumber();
-      int intVal = (int)doubleVal;
-      long long longVal = (long)doubleVal;
-      if (intVal == doubleVal) {
-        res.push_back(JSVariant(intVal));
-      } else if (longVal == doubleVal) {
-        res.push_back(JSVariant(longVal));
-      } else {
-        res.push_back(JSVariant(doubleVal));
-      }
+      res.push_back(number_to_variant(value.asNumber()));
+    } else if (value.isBigInt()) {
+      res.push_back(big_int_to_variant(rt, value));
     } else if (value.isString()) {
       std::string strVal = value.asString(rt).utf8(rt);
       res.push_back(JSVariant(strVal));
@@ -136,15 +261,17 @@ std::vector<JSVariant> to_variant_vec(jsi::Runtime &rt, jsi::Value const &xs) {
       if (obj.isArrayBuffer(rt)) {
         auto buffer = obj.getArrayBuffer(rt);
         size_t size = buffer.size(rt);
-        uint8_t *data = new uint8_t[size];
-        // You cannot share raw memory between native and JS
-        // always copy the data
-        // see https://github.com/facebook/hermes/pull/419 and
-        // https://github.com/facebook/hermes/issues/564.
-        memcpy(data, buffer.data(rt), size);
-
-        res.push_back(JSVariant(ArrayBuffer{
-            .data = std::shared_ptr<uint8_t>{data}, .size = buffer.size(rt)}));
+
+        if (borrow_buffers) {
+          auto borrowed =
+              std::shared_ptr<uint8_t>(buffer.data(rt), [](uint8_t *) {});
+          res.push_back(
+              JSVariant(ArrayBuffer{.data = borrowed, .size = size}));
+        } else {
+          // The memory of the buffer can only be accessed from the JS thread,
+          // copy it for anything that runs on a different one
+          res.push_back(JSVariant(copy_array_buffer(buffer.data(rt), size)));
+        }
       } else {
         throw std::invalid_argument(
             "Unknown JSI ArrayBuffer to variant value conversion, received "
@@ -158,10 +285,153 @@ std::vector<JSVariant> to_variant_vec(jsi::Runtime &rt, jsi::Value const &xs) {
   return res;
 }
 
+/// Reads the priority property of an options object, fallback when it is
+/// not given
+TaskPriority to_task_priority(jsi::Runtime &rt, jsi::Value const &options,
+                              TaskPriority fallback) {
+  if (!options.isObject()) {
+    return fallback;
+  }
+
+  auto priority = options.asObject(rt).getProperty(rt, "priority");
+  if (!priority.isString()) {
+    return fallback;
+  }
+
+  auto priority_str = priority.asString(rt).utf8(rt);
+  if (priority_str == "interactive") {
+    return InteractivePriority;
+  }
+  if (priority_str == "normal") {
+    return NormalPriority;
+  }
+  if (priority_str == "background") {
+    return BackgroundPriority;
+  }
+
+  throw std::invalid_argument(
+      "[op-sqlite] priority must be interactive, normal or background");
+}
+
+/// Reads the optional `{rowMode, lazyRows}` argument of the execute functions
+ExecuteOptions to_execute_options(jsi::Runtime &rt,
+                                  jsi::Value const &options) {
+  ExecuteOptions res;
+
+  if (!options.isObject()) {
+    return res;
+  }
+
+  auto options_obj = options.asObject(rt);
+
+  auto row_mode = options_obj.getProperty(rt, "rowMode");
+  if (row_mode.isString()) {
+    auto row_mode_str = row_mode.asString(rt).utf8(rt);
+    if (row_mode_str == "object") {
+      res.row_mode = PlainObjectRows;
+    } else if (row_mode_str != "hostObject") {
+      throw std::invalid_argument(
+          "[op-sqlite] rowMode must be either hostObject or object");
+    }
+  }
+
+  auto lazy_rows = options_obj.getProperty(rt, "lazyRows");
+  res.lazy_rows = lazy_rows.isBool() && lazy_rows.getBool();
+
+  auto big_ints = options_obj.getProperty(rt, "bigInt");
+  res.big_ints = big_ints.isBool() && big_ints.getBool();
+
+  auto chunk_budget = options_obj.getProperty(rt, "chunkBudgetMs");
+  if (chunk_budget.isNumber() && chunk_budget.getNumber() > 0) {
+    res.chunk_budget_ms = chunk_budget.getNumber();
+  }
+
+  auto on_chunk = options_obj.getProperty(rt, "onChunk");
+  if (on_chunk.isObject() && on_chunk.asObject(rt).isFunction(rt)) {
+    res.on_chunk = std::make_shared<jsi::Value>(rt, on_chunk);
+    if (res.chunk_budget_ms == 0) {
+      res.chunk_budget_ms = 8;
+    }
+  }
+
+  res.priority = to_task_priority(rt, options);
+
+  auto cache = options_obj.getProperty(rt, "cache");
+  res.cache = cache.isBool() && cache.getBool();
+
+  auto timeout = options_obj.getProperty(rt, "timeoutMs");
+  if (timeout.isNumber() && timeout.getNumber() > 0) {
+    res.cancellation = std::make_shared<CancellationToken>();
+    res.cancellation->deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(timeout.getNumber()));
+  }
+
+  // An AbortSignal, or anything with aborted and addEventListener
+  auto signal = options_obj.getProperty(rt, "signal");
+  if (signal.isObject()) {
+    if (res.cancellation == nullptr) {
+      res.cancellation = std::make_shared<CancellationToken>();
+    }
+
+    auto signal_obj = signal.asObject(rt);
+    auto aborted = signal_obj.getProperty(rt, "aborted");
+
+    if (aborted.isBool() && aborted.getBool()) {
+      res.cancellation->cancelled = true;
+    } else {
+      std::weak_ptr<CancellationToken> weak_cancellation = res.cancellation;
+      auto on_abort = jsi::Function::createFromHostFunction(
+          rt, jsi::PropNameID::forAscii(rt, "onAbort"), 0,
+          [weak_cancellation](jsi::Runtime &rt, const jsi::Value &thisValue,
+                              const jsi::Value *args,
+                              size_t count) -> jsi::Value {
+            if (auto cancellation = weak_cancellation.lock()) {
+              cancellation->cancelled = true;
+            }
+            return {};
+          });
+
+      auto once = jsi::Object(rt);
+      once.setProperty(rt, "once", true);
+      signal_obj.getPropertyAsFunction(rt, "addEventListener")
+          .callWithThis(rt, signal_obj,
+                        jsi::String::createFromAscii(rt, "abort"),
+                        std::move(on_abort), std::move(once));
+    }
+  }
+
+  return res;
+}
+
+jsi::Value create_row(jsi::Runtime &rt,
+                      std::shared_ptr<ResultBuffer> const &results, size_t row,
+                      RowMode row_mode) {
+  if (row_mode == HostObjectRows) {
+    return jsi::Object::createFromHostObject(
+        rt, std::make_shared<DumbHostObject>(results, row));
+  }
+
+  // Properties are always added in the same order, so the engine gives every
+  // row the same hidden class
+  auto &columns = *results->columns;
+  auto res = jsi::Object(rt);
+  for (size_t i = 0; i < columns.size(); i++) {
+    if (!columns.is_shadowed(i)) {
+      res.setProperty(rt, columns.prop_name(rt, i),
+                      results->get_value(rt, row, i));
+    }
+  }
+
+  return std::move(res);
+}
+
 jsi::Value
 createResult(jsi::Runtime &rt, BridgeResult status,
-             std::vector<DumbHostObject> *results,
-             std::shared_ptr<std::vector<SmartHostObject>> metadata) {
+             std::shared_ptr<ResultBuffer> results,
+             std::shared_ptr<std::vector<SmartHostObject>> metadata,
+             ExecuteOptions const &options) {
   if (status.type == SQLiteError) {
     throw std::invalid_argument(status.message);
   }
@@ -173,17 +443,25 @@ createResult(jsi::Runtime &rt, BridgeResult status,
     res.setProperty(rt, "insertId", jsi::Value(status.insertId));
   }
 
-  size_t rowCount = results->size();
+  // Applies to rows read later too
+  results->big_ints = options.big_ints;
+
+  size_t rowCount = results->row_count();
   jsi::Object rows = jsi::Object(rt);
   rows.setProperty(rt, "length", jsi::Value((int)rowCount));
 
-  if (rowCount > 0) {
+  if (rowCount > 0 && options.lazy_rows) {
+    // Turned into rows._array on the JS side
+    rows.setProperty(rt, "_lazyRows",
+                     jsi::Object::createFromHostObject(
+                         rt, std::make_shared<LazyRowsHostObject>(
+                                 results, options.row_mode)));
+    res.setProperty(rt, "rows", std::move(rows));
+  } else if (rowCount > 0) {
     auto array = jsi::Array(rt, rowCount);
-    for (int i = 0; i < rowCount; i++) {
-      auto obj = results->at(i);
+    for (size_t i = 0; i < rowCount; i++) {
       array.setValueAtIndex(rt, i,
-                            jsi::Object::createFromHostObject(
-                                rt, std::make_shared<DumbHostObject>(obj)));
+                            create_row(rt, results, i, options.row_mode));
     }
     rows.setProperty(rt, "_array", std::move(array));
     res.setProperty(rt, "rows", std::move(rows));
@@ -258,6 +536,93 @@ void to_batch_arguments(jsi::Runtime &rt, jsi::Array const &batchParams,
   }
 }
 
+/// Reads `{column: Float64Array | Int32Array | (string | null)[]}`. Typed
+/// arrays are read in place when borrow_buffers is set, otherwise each one is
+/// copied once so it can be used from another thread
+std::vector<ColumnValues> to_column_values(jsi::Runtime &rt,
+                                           jsi::Object const &columns,
+                                           bool borrow_buffers, size_t *rows) {
+  std::vector<ColumnValues> res;
+  auto names = columns.getPropertyNames(rt);
+  auto float64Ctr = rt.global().getPropertyAsFunction(rt, "Float64Array");
+  auto int32Ctr = rt.global().getPropertyAsFunction(rt, "Int32Array");
+
+  for (size_t i = 0; i < names.size(rt); i++) {
+    std::string name = names.getValueAtIndex(rt, i).asString(rt).utf8(rt);
+    jsi::Value value = columns.getProperty(rt, name.c_str());
+
+    if (!value.isObject()) {
+      throw std::invalid_argument("[op-sqlite][insertColumns] values of " +
+                                  name + " must be a Float64Array, an "
+                                         "Int32Array or an array of strings");
+    }
+
+    auto object = value.asObject(rt);
+    ColumnValues column{.name = name, .numbers = nullptr};
+    size_t length;
+
+    if (object.isArray(rt)) {
+      auto array = object.asArray(rt);
+      length = array.length(rt);
+      column.type = TextColumn;
+      column.texts.reserve(length);
+
+      for (size_t row = 0; row < length; row++) {
+        auto text = array.getValueAtIndex(rt, row);
+        if (text.isNull() || text.isUndefined()) {
+          column.texts.push_back(JSVariant(nullptr));
+        } else {
+          column.texts.push_back(JSVariant(text.asString(rt).utf8(rt)));
+        }
+      }
+    } else {
+      size_t element_size;
+
+      if (object.instanceOf(rt, float64Ctr)) {
+        column.type = Float64Column;
+        element_size = sizeof(double);
+      } else if (object.instanceOf(rt, int32Ctr)) {
+        column.type = Int32Column;
+        element_size = sizeof(int32_t);
+      } else {
+        throw std::invalid_argument("[op-sqlite][insertColumns] values of " +
+                                    name + " must be a Float64Array, an "
+                                           "Int32Array or an array of strings");
+      }
+
+      auto buffer =
+          object.getPropertyAsObject(rt, "buffer").getArrayBuffer(rt);
+      size_t offset =
+          static_cast<size_t>(object.getProperty(rt, "byteOffset").asNumber());
+      length = static_cast<size_t>(object.getProperty(rt, "length").asNumber());
+      const uint8_t *data = buffer.data(rt) + offset;
+
+      if (borrow_buffers) {
+        column.numbers = data;
+      } else {
+        column.owner = copy_array_buffer(data, length * element_size).data;
+        column.numbers = column.owner.get();
+      }
+    }
+
+    if (res.empty()) {
+      *rows = length;
+    } else if (length != *rows) {
+      throw std::invalid_argument(
+          "[op-sqlite][insertColumns] all columns must have the same length");
+    }
+
+    res.push_back(std::move(column));
+  }
+
+  if (res.empty()) {
+    throw std::invalid_argument(
+        "[op-sqlite][insertColumns] at least one column is needed");
+  }
+
+  return res;
+}
+
 #ifndef OP_SQLITE_USE_LIBSQL
 BatchResult importSQLFile(std::string dbName, std::string fileLocation) {
   std::string line;
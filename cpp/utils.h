@@ -2,7 +2,9 @@
 #define utils_h
 
 #include "DumbHostObject.h"
+#include "ResultBuffer.h"
 #include "SmartHostObject.h"
+#include "ThreadPool.h"
 #include "types.h"
 #include <any>
 #include <jsi/jsi.h>
@@ -15,19 +17,82 @@ namespace opsqlite {
 
 namespace jsi = facebook::jsi;
 
+/// Backs a JS ArrayBuffer with a native allocation, the memory is handed to
+/// JS without copying and freed once both sides are done with it
+class SharedBuffer : public jsi::MutableBuffer {
+public:
+  SharedBuffer(std::shared_ptr<uint8_t> data, size_t size)
+      : _data(std::move(data)), _size(size){};
+
+  size_t size() const override { return _size; }
+  uint8_t *data() override { return _data.get(); }
+
+private:
+  std::shared_ptr<uint8_t> _data;
+  size_t _size;
+};
+
+/// How createResult hands rows to JS. Host objects are created faster, plain
+/// objects are faster to read, all of them share one shape
+enum RowMode { HostObjectRows, PlainObjectRows };
+
+/// The optional last argument of the execute functions
+struct ExecuteOptions {
+  RowMode row_mode = HostObjectRows;
+  // Rows are created when JS first reads them instead of all up front
+  bool lazy_rows = false;
+  bool big_ints = false;
+  // executeAsync only, rows are converted to JS in chunks that take at most
+  // this long, 0 converts them all at once
+  double chunk_budget_ms = 0;
+  // Receives each chunk of rows instead of the result
+  std::shared_ptr<jsi::Value> on_chunk;
+  // Set when a signal or a timeout was given
+  std::shared_ptr<CancellationToken> cancellation;
+  // Lane of the thread pool the async functions queue the query on
+  TaskPriority priority = NormalPriority;
+  // Served from the result cache of the database when it is on
+  bool cache = false;
+};
+
+/// Integers a JS number holds exactly, up to Number.MAX_SAFE_INTEGER
+inline bool is_safe_integer(int64_t value) {
+  return value >= -9007199254740991LL && value <= 9007199254740991LL;
+}
+
 jsi::Value toJSI(jsi::Runtime &rt, JSVariant value);
 JSVariant toVariant(jsi::Runtime &rt, jsi::Value const &value);
+ArrayBuffer copy_array_buffer(const void *data, size_t size);
+/// Single SELECT statements, the only queries whose results are shared or
+/// cached. WITH is left out since it may prefix a write
+bool is_single_select(std::string const &query);
+/// Identifies a read by its query, with the whitespace collapsed outside of
+/// literals and before the first comment, and its bound values. bigInt is part of it since rows read
+/// lazily use the option of their buffer
+std::string query_key(std::string const &query,
+                      std::vector<JSVariant> const &params, bool big_ints);
 std::vector<std::string> to_string_vec(jsi::Runtime &rt, jsi::Value const &xs);
-std::vector<JSVariant> to_variant_vec(jsi::Runtime &rt, jsi::Value const &xs);
+std::vector<JSVariant> to_variant_vec(jsi::Runtime &rt, jsi::Value const &xs,
+                                      bool borrow_buffers = false);
 std::vector<int> to_int_vec(jsi::Runtime &rt, jsi::Value const &xs);
+ExecuteOptions to_execute_options(jsi::Runtime &rt, jsi::Value const &options);
+TaskPriority to_task_priority(jsi::Runtime &rt, jsi::Value const &options,
+                              TaskPriority fallback = NormalPriority);
+jsi::Value create_row(jsi::Runtime &rt,
+                      std::shared_ptr<ResultBuffer> const &results, size_t row,
+                      RowMode row_mode);
 jsi::Value createResult(jsi::Runtime &rt, BridgeResult status,
-                        std::vector<DumbHostObject> *results,
-                        std::shared_ptr<std::vector<SmartHostObject>> metadata);
+                        std::shared_ptr<ResultBuffer> results,
+                        std::shared_ptr<std::vector<SmartHostObject>> metadata,
+                        ExecuteOptions const &options = {});
 jsi::Value
 create_raw_result(jsi::Runtime &rt, BridgeResult status,
                   const std::vector<std::vector<JSVariant>> *results);
 void to_batch_arguments(jsi::Runtime &rt, jsi::Array const &batchParams,
                         std::vector<BatchArguments> *commands);
+std::vector<ColumnValues> to_column_values(jsi::Runtime &rt,
+                                           jsi::Object const &columns,
+                                           bool borrow_buffers, size_t *rows);
 
 BatchResult importSQLFile(std::string dbName, std::string fileLocation);
 
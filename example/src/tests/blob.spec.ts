@@ -101,5 +101,37 @@ export function blobTests() {
       const finalUint8 = new Uint8Array(result.rows!._array[0].content);
       expect(finalUint8[0]).to.equal(52);
     });
+
+    it('Large blob round trip', async () => {
+      const uint8 = new Uint8Array(1024 * 1024);
+      for (let i = 0; i < uint8.length; i++) {
+        uint8[i] = i % 251;
+      }
+
+      db.execute(`INSERT OR REPLACE INTO BlobTable VALUES (?, ?);`, [1, uint8]);
+      // Bound buffers are read in place, changing them later must not change
+      // the stored data
+      uint8[0] = 99;
+
+      const result = db.execute('SELECT content FROM BlobTable');
+      const finalUint8 = new Uint8Array(result.rows!._array[0].content);
+      expect(finalUint8.length).to.equal(1024 * 1024);
+      expect(finalUint8[0]).to.equal(0);
+      expect(finalUint8[1024 * 1024 - 1]).to.equal((1024 * 1024 - 1) % 251);
+    });
+
+    it('Blob in async execute', async () => {
+      const uint8 = new Uint8Array(2);
+      uint8[0] = 61;
+
+      await db.executeAsync(`INSERT OR REPLACE INTO BlobTable VALUES (?, ?);`, [
+        1,
+        uint8,
+      ]);
+
+      const result = await db.executeAsync('SELECT content FROM BlobTable');
+      const finalUint8 = new Uint8Array(result.rows!._array[0].content);
+      expect(finalUint8[0]).to.equal(61);
+    });
   });
 }
@@ -160,5 +160,83 @@ export function dbSetupTests() {
         db.close();
       }
     });
+
+    if (!isLibsql()) {
+      it('Reads in parallel on reader connections', async () => {
+        let db = open({
+          name: 'readersTest.sqlite',
+          encryptionKey: 'test',
+          readerConnections: 4,
+        });
+
+        db.execute('DROP TABLE IF EXISTS Item;');
+        db.execute('CREATE TABLE Item (id INTEGER PRIMARY KEY, value TEXT);');
+        for (let i = 0; i < 50; i++) {
+          db.execute('INSERT INTO Item (value) VALUES (?);', [`item${i}`]);
+        }
+
+        const mode = db.execute('PRAGMA journal_mode;');
+        expect(mode.rows?._array[0].journal_mode).to.equal('wal');
+
+        const reads = [];
+        for (let i = 0; i < 20; i++) {
+          reads.push(db.executeAsync('SELECT COUNT(*) as count FROM Item;'));
+        }
+        const results = await Promise.all(reads);
+        results.forEach(res => {
+          expect(res.rows?._array[0].count).to.equal(50);
+        });
+
+        // Writes sent through executeAsync still go to the main connection
+        await db.executeAsync('INSERT INTO Item (value) VALUES (?);', ['last']);
+        const raw = await db.executeRawAsync('SELECT COUNT(*) FROM Item;');
+        expect(raw).to.eql([[51]]);
+
+        // A read sent right after BEGIN sees the changes of the transaction
+        const begin = db.executeAsync('BEGIN');
+        const insert = db.executeAsync('INSERT INTO Item (value) VALUES (?);', [
+          'uncommitted',
+        ]);
+        const inside = db.executeAsync('SELECT COUNT(*) as count FROM Item;');
+        await Promise.all([begin, insert]);
+        expect((await inside).rows?._array[0].count).to.equal(52);
+        await db.executeAsync('ROLLBACK');
+
+        db.close();
+        db.delete();
+      });
+
+      it('Mixes sync and async queries on an owned connection', async () => {
+        let db = open({
+          name: 'ownedTest.sqlite',
+          encryptionKey: 'test',
+          ownedConnection: true,
+        });
+
+        db.execute('DROP TABLE IF EXISTS Item;');
+        db.execute('CREATE TABLE Item (id INTEGER PRIMARY KEY, value TEXT);');
+
+        const writes = [];
+        for (let i = 0; i < 50; i++) {
+          writes.push(
+            db.executeAsync('INSERT INTO Item (value) VALUES (?);', [`a${i}`]),
+          );
+          db.execute('INSERT INTO Item (value) VALUES (?);', [`s${i}`]);
+        }
+        await Promise.all(writes);
+
+        const res = db.execute('SELECT COUNT(*) as count FROM Item;');
+        expect(res.rows?._array[0].count).to.equal(100);
+
+        const statement = db.prepareStatement(
+          'SELECT value FROM Item WHERE id = ?',
+        );
+        statement.bind([1]);
+        expect(statement.execute().rows?._array.length).to.equal(1);
+
+        db.close();
+        db.delete();
+      });
+    }
   });
 }
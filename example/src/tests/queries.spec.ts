@@ -1,5 +1,6 @@
 import Chance from 'chance';
 import {
+  configureThreadPool,
   isLibsql,
   open,
   openRemote,
@@ -203,6 +204,26 @@ export function queriesTests() {
       expect(t2name.rows?._array[0].name).to.equal('T2');
     });
 
+    it('Fails statements whose rows have different columns', () => {
+      if (isLibsql()) {
+        return;
+      }
+      const same = db.execute('SELECT 1 as a; SELECT 2 as a;', [], {
+        rowMode: 'object',
+      });
+      expect(same.rows?._array).to.eql([{a: 1}, {a: 2}]);
+
+      const empty = db.execute("SELECT id FROM User; SELECT 'x' as b;", [], {
+        rowMode: 'object',
+      });
+      expect(empty.rows?._array).to.eql([{b: 'x'}]);
+      expect(empty.metadata?.map(column => column.name)).to.eql(['b']);
+
+      expect(() =>
+        db.execute("SELECT 1 as a; SELECT 'x' as b, 'y' as c;"),
+      ).to.throw('different columns');
+    });
+
     it('Failed insert', async () => {
       const id = chance.string();
       const name = chance.name();
@@ -447,12 +468,28 @@ export function queriesTests() {
           'INSERT INTO "User" (id, name, age, networth) VALUES(?, ?, ?, ?)',
           [id, name, age, networth],
         );
-        tx.rollback();
+        await tx.rollback();
         const res = db.execute('SELECT * FROM User');
         expect(res.rows?._array).to.eql([]);
       });
     });
 
+    it('Transaction, commit runs after queued async statements', async () => {
+      const id = chance.integer();
+
+      await db.transaction(async tx => {
+        tx.executeAsync('INSERT INTO "User" (id, name) VALUES(?, ?)', [
+          id,
+          chance.name(),
+        ]);
+        const res = await tx.commit();
+        expect(res.rowsAffected).to.be.a('number');
+      });
+
+      const res = db.execute('SELECT id FROM User');
+      expect(res.rows?._array.map(row => row.id)).to.eql([id]);
+    });
+
     it('Transaction, rejects on callback error', async () => {
       const promised = db.transaction(() => {
         throw new Error('Error from callback');
@@ -655,6 +692,95 @@ export function queriesTests() {
       );
     });
 
+    it('Transaction, savepoint rolls back only its changes', async () => {
+      await db.transaction(async tx => {
+        tx.execute('INSERT INTO User (id, name) VALUES(?, ?)', [
+          1,
+          chance.name(),
+        ]);
+
+        await tx.savepoint(async sp => {
+          sp.execute('INSERT INTO User (id, name) VALUES(?, ?)', [
+            2,
+            chance.name(),
+          ]);
+
+          try {
+            await sp.savepoint(async inner => {
+              inner.execute('INSERT INTO User (id, name) VALUES(?, ?)', [
+                3,
+                chance.name(),
+              ]);
+              throw new Error('Inner savepoint failed');
+            });
+          } catch (e) {
+            expect((e as Error).message).to.equal('Inner savepoint failed');
+          }
+        });
+      });
+
+      const res = db.execute('SELECT id FROM User ORDER BY id');
+      expect(res.rows?._array).to.eql([{id: 1}, {id: 2}]);
+    });
+
+    if (!isLibsql()) {
+      it('Transaction, sync execute throws while async statements run', async () => {
+        await db.transaction(async tx => {
+          const pending = tx.executeAsync(
+            'INSERT INTO User (id, name) VALUES(?, ?)',
+            [1, chance.name()],
+          );
+
+          expect(() => tx.execute('SELECT COUNT(*) FROM User')).to.throw(
+            /still running/,
+          );
+
+          await pending;
+          const res = tx.execute('SELECT COUNT(*) as count FROM User');
+          expect(res.rows?._array[0].count).to.equal(1);
+        });
+      });
+
+      it('Transaction runs the db calls sent while it is open', async () => {
+        await db.transaction(async tx => {
+          await tx.executeAsync('INSERT INTO User (id, name) VALUES(?, ?)', [
+            1,
+            chance.name(),
+          ]);
+
+          // Would never resolve if it waited for the transaction to end
+          const res = await db.executeAsync(
+            'SELECT COUNT(*) as count FROM User',
+          );
+          expect(res.rows?._array[0].count).to.equal(1);
+
+          await tx.rollback();
+        });
+
+        const res = db.execute('SELECT COUNT(*) as count FROM User');
+        expect(res.rows?._array[0].count).to.equal(0);
+      });
+
+      it('Closing the database releases an open transaction', async () => {
+        const other = open({
+          name: 'abandonedTransaction.sqlite',
+          encryptionKey: 'test',
+        });
+
+        await other.beginTransaction();
+        const waiting = other.beginTransaction();
+        other.close();
+
+        let error;
+        try {
+          await waiting;
+        } catch (e) {
+          error = e;
+        }
+        expect(error).to.exist;
+      });
+    }
+
     it('Async transaction, rejects on callback error', async () => {
       const promised = db.transaction(async () => {
         throw new Error('Error from callback');
@@ -763,6 +889,61 @@ export function queriesTests() {
       ]);
     });
 
+    it('Batch execute in chunks', async () => {
+      const rows = Array.from({length: 1000}, (_, i) => [i, chance.name()]);
+
+      const res = await db.executeBatchAsync(
+        [['INSERT INTO User (id, name) VALUES(?, ?)', rows]],
+        {transactionMode: 'immediate', chunkSize: 100},
+      );
+      expect(res.rowsAffected).to.equal(1000);
+
+      const count = db.execute('SELECT COUNT(*) as count FROM User');
+      expect(count.rows?._array[0].count).to.equal(1000);
+    });
+
+    if (!isLibsql()) {
+      it('Batch execute rolls back on error', () => {
+        try {
+          db.executeBatch([
+            ['INSERT INTO User (id, name) VALUES(?, ?)', [1, chance.name()]],
+            ['INSERT INTO User (id, name) VALUES(?, ?)', [1, chance.name()]],
+          ]);
+          expect.fail('Should throw');
+        } catch (e) {
+          expect(e).to.be.instanceOf(Error);
+        }
+
+        const count = db.execute('SELECT COUNT(*) as count FROM User');
+        expect(count.rows?._array[0].count).to.equal(0);
+      });
+    }
+
+    if (!isLibsql()) {
+      it('Insert columns from typed arrays', async () => {
+        const ids = Int32Array.from({length: 100}, (_, i) => i);
+        const networths = Float64Array.from({length: 100}, (_, i) => i / 2);
+        const names = Array.from({length: 100}, () => chance.name());
+
+        const res = db.insertColumns('User', {
+          id: ids,
+          networth: networths,
+          name: names,
+        });
+        expect(res.rowsAffected).to.equal(100);
+
+        await db.insertColumnsAsync('User', {
+          id: ids.subarray(50).map(id => id + 100),
+          name: names.slice(50),
+        });
+
+        const rows = db.execute(
+          'SELECT COUNT(*) as count, SUM(networth) as total FROM User',
+        );
+        expect(rows.rows?._array[0]).to.eql({count: 150, total: 2475});
+      });
+    }
+
     it('DumbHostObject allows to write known props', async () => {
       const id = chance.integer();
       const name = chance.name();
@@ -821,6 +1002,105 @@ export function queriesTests() {
       expect(res.rows!._array[0].myWeirdProp).to.eq('quack_changed');
     });
 
+    it('DumbHostObject reads columns in any order', async () => {
+      const res = db.execute('SELECT 1 as a, 2 as b, 3 as a, 4 as c');
+      const row = res.rows!._array[0];
+
+      expect(row.c).to.equal(4);
+      expect(row.a).to.equal(1);
+      expect(row.b).to.equal(2);
+      expect(row.missing).to.equal(undefined);
+    });
+
+    it('Execute returns plain object rows', async () => {
+      const res = await db.executeAsync(
+        'SELECT 1 as a, 2 as b, 3 as a, null as c',
+        [],
+        {rowMode: 'object'},
+      );
+
+      expect(res.rows!._array).to.eql([{a: 1, b: 2, c: null}]);
+      expect(Object.keys(res.rows!._array[0])).to.eql(['a', 'b', 'c']);
+    });
+
+    it('Execute creates lazy rows when read', async () => {
+      for (let i = 0; i < 10; i++) {
+        db.execute('INSERT INTO User (id, name) VALUES(?, ?)', [i, `user${i}`]);
+      }
+
+      const res = await db.executeAsync(
+        'SELECT id, name FROM User ORDER BY id',
+        [],
+        {lazyRows: true},
+      );
+      const rows = res.rows!._array;
+
+      expect(rows.length).to.equal(10);
+      expect(Array.isArray(rows)).to.equal(true);
+      expect(rows[9].name).to.equal('user9');
+      expect(rows[10]).to.equal(undefined);
+      expect(rows.map(row => row.id)).to.eql([0, 1, 2, 3, 4, 5, 6, 7, 8, 9]);
+      expect(res.rows!.item(3).name).to.equal('user3');
+    });
+
+    it('Integers keep 64 bits of precision', async () => {
+      const id = BigInt('9007199254740993');
+      db.execute('INSERT INTO User (id, name, age) VALUES(?, ?, ?)', [
+        id,
+        'snowflake',
+        2 ** 40,
+      ]);
+
+      const res = await db.executeAsync('SELECT id, age FROM User', [], {
+        bigInt: true,
+      });
+
+      expect(res.rows!._array[0].id).to.equal(id);
+      expect(res.rows!._array[0].age).to.equal(2 ** 40);
+
+      const rounded = db.execute('SELECT id FROM User');
+      expect(rounded.rows!._array[0].id).to.equal(9007199254740992);
+    });
+
+    it('Reads values that do not match the declared column type', () => {
+      db.execute('CREATE TABLE Loose (a INT, b TEXT)');
+      db.execute("INSERT INTO Loose VALUES (10, 'x'), ('ten', 2), (NULL, NULL)");
+
+      const res = db.execute('SELECT a, b FROM Loose ORDER BY rowid');
+
+      expect(res.rows!._array.map(row => [row.a, row.b])).to.eql([
+        [10, 'x'],
+        ['ten', '2'],
+        [null, null],
+      ]);
+    });
+
+    it('Execute async delivers large results in chunks', async () => {
+      db.execute(
+        "WITH RECURSIVE n(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM n WHERE i < 4999) INSERT INTO User (id, name) SELECT i, 'user' || i FROM n",
+      );
+
+      const collected = await db.executeAsync(
+        'SELECT id, name FROM User ORDER BY id',
+        [],
+        {chunkBudgetMs: 1},
+      );
+      expect(collected.rows!.length).to.equal(5000);
+      expect(collected.rows!._array[4999].name).to.equal('user4999');
+
+      const chunks: any[][] = [];
+      const streamed = await db.executeAsync(
+        'SELECT id FROM User ORDER BY id',
+        [],
+        {chunkBudgetMs: 1, onChunk: rows => chunks.push(rows)},
+      );
+      const ids = chunks.flat().map(row => row.id);
+      expect(ids.length).to.equal(5000);
+      expect(ids[0]).to.equal(0);
+      expect(ids[4999]).to.equal(4999);
+      expect(streamed.rows!._array).to.eql([]);
+    });
+
     it('Execute raw should return just an array of objects', async () => {
       const id = chance.integer();
       const name = chance.name();
@@ -837,6 +1117,327 @@ export function queriesTests() {
       expect(res).to.eql([[id, name, age, networth]]);
     });
 
+    if (!isLibsql()) {
+      it('Reuses cached statements for repeated queries', () => {
+        const before = db.getStatementCacheStats();
+
+        for (let i = 0; i < 5; i++) {
+          db.execute('INSERT INTO User (id, name) VALUES(?, ?)', [
+            i,
+            chance.name(),
+          ]);
+        }
+
+        const after = db.getStatementCacheStats();
+        expect(after.misses - before.misses).to.equal(1);
+        expect(after.hits - before.hits).to.equal(4);
+
+        const res = db.execute('SELECT * FROM User');
+        expect(res.rows?._array.length).to.equal(5);
+      });
+
+      it('Cached statements see schema changes', () => {
+        db.execute('SELECT * FROM User');
+        db.execute('ALTER TABLE User ADD COLUMN email TEXT');
+        expect(db.getStatementCacheStats().size).to.equal(0);
+
+        const res = db.execute('SELECT * FROM User');
+        expect(res.metadata?.map(column => column.name)).to.include('email');
+      });
+
+      it('Async queries on the same database run in order', async () => {
+        const promises = [];
+        for (let i = 0; i < 20; i++) {
+          promises.push(
+            db.executeAsync('INSERT INTO User (id, name) VALUES(?, ?)', [
+              i,
+              chance.name(),
+            ]),
+          );
+        }
+        await Promise.all(promises);
+
+        const res = db.execute('SELECT id FROM User ORDER BY rowid');
+        expect(res.rows?._array.map(row => row.id)).to.eql(
+          Array.from({length: 20}, (_, i) => i),
+        );
+      });
+
+      it('Group commit resolves every write with its own result', async () => {
+        db.setGroupCommit({windowMs: 5, maxWrites: 10});
+
+        const promises = [];
+        for (let i = 0; i < 25; i++) {
+          promises.push(
+            db.executeAsync('INSERT INTO User (id, name) VALUES(?, ?)', [
+              // Duplicated primary key, only this write should fail
+              i === 12 ? 11 : i,
+              chance.name(),
+            ]),
+          );
+        }
+        const results = await Promise.allSettled(promises);
+        db.setGroupCommit(null);
+
+        const insertIds = new Set();
+        results.forEach((result, i) => {
+          if (i === 12) {
+            expect(result.status).to.equal('rejected');
+          } else {
+            expect(result.status).to.equal('fulfilled');
+            expect((result as any).value.rowsAffected).to.equal(1);
+            insertIds.add((result as any).value.insertId);
+          }
+        });
+        expect(insertIds.size).to.equal(24);
+
+        const res = db.execute('SELECT COUNT(*) as count FROM User');
+        expect(res.rows?._array[0].count).to.equal(24);
+      });
+
+      it('Concurrent async queries settle with their own results', async () => {
+        const promises = [];
+        for (let i = 0; i < 50; i++) {
+          promises.push(
+            i % 10 === 9
+              ? db.executeAsync('SELECT * FROM MissingTable')
+              : db.executeAsync('SELECT ? as value', [i]),
+          );
+        }
+        const results = await Promise.allSettled(promises);
+
+        results.forEach((result, i) => {
+          if (i % 10 === 9) {
+            expect(result.status).to.equal('rejected');
+            expect((result as any).reason).to.be.instanceOf(Error);
+          } else {
+            expect(result.status).to.equal('fulfilled');
+            expect((result as any).value.rows._array[0].value).to.equal(i);
+          }
+        });
+      });
+
+      it('Shares identical in-flight reads', async () => {
+        db.execute('INSERT INTO User (id, name) VALUES(1, ?)', ['Ada']);
+        db.setSingleFlight(true);
+
+        try {
+          const query = 'SELECT id, name FROM User WHERE id = ?';
+          const [first, second, objects, other, afterWrite] =
+            await Promise.all([
+              db.executeAsync(query, [1]),
+              db.executeAsync(query, [1]),
+              db.executeAsync(query, [1], {rowMode: 'object'}),
+              db.executeAsync(query, [2]),
+              db
+                .executeAsync('UPDATE User SET name = ? WHERE id = 1', ['Grace'])
+                .then(() => db.executeAsync(query, [1])),
+            ]);
+
+          expect(first).to.not.equal(second);
+          expect(first.rows?._array[0].name).to.equal('Ada');
+          expect(second.rows?._array[0].name).to.equal('Ada');
+          expect(objects.rows?._array[0]).to.eql({id: 1, name: 'Ada'});
+          expect(other.rows?._array).to.eql([]);
+          expect(afterWrite.rows?._array[0].name).to.equal('Grace');
+        } finally {
+          db.setSingleFlight(false);
+        }
+      });
+
+      it('Does not share reads that differ after a comment', async () => {
+        db.setSingleFlight(true);
+
+        try {
+          const [split, commented] = await Promise.all([
+            db.executeAsync('SELECT 1 as a --x\n, 2 as b', [], {
+              rowMode: 'object',
+            }),
+            db.executeAsync('SELECT 1 as a --x , 2 as b', [], {
+              rowMode: 'object',
+            }),
+          ]);
+
+          expect(split.rows?._array).to.eql([{a: 1, b: 2}]);
+          expect(commented.rows?._array).to.eql([{a: 1}]);
+        } finally {
+          db.setSingleFlight(false);
+        }
+      });
+
+      it('Caches results until a table they read changes', async () => {
+        db.execute('INSERT INTO User (id, name) VALUES(1, ?)', ['Ada']);
+        db.setResultCache({maxEntries: 10});
+
+        try {
+          const query = 'SELECT id, name FROM User WHERE id = ?';
+          await db.executeAsync(query, [1], {cache: true});
+          const cached = db.execute(query, [1], {cache: true});
+          expect(cached.rows?._array[0].name).to.equal('Ada');
+          expect(db.getResultCacheStats().hits).to.equal(1);
+
+          // Sent after the write, the read cannot be answered before it runs
+          const write = db.executeAsync(
+            'UPDATE User SET name = ? WHERE id = 1',
+            ['Grace'],
+          );
+          const fresh = await db.executeAsync(query, [1], {cache: true});
+          await write;
+          expect(fresh.rows?._array[0].name).to.equal('Grace');
+
+          const stats = db.getResultCacheStats();
+          expect(stats.hits).to.equal(1);
+          expect(stats.invalidations).to.equal(1);
+        } finally {
+          db.setResultCache(null);
+        }
+      });
+
+      it('Runs async queries on an elastic thread pool', async () => {
+        configureThreadPool({maxThreads: 2, elastic: true, growAfterMs: 1});
+
+        try {
+          const results = await Promise.all(
+            Array.from({length: 20}, (_, i) =>
+              db.executeAsync('SELECT ? as value', [i]),
+            ),
+          );
+          results.forEach((res, i) => {
+            expect(res.rows?._array[0].value).to.equal(i);
+          });
+        } finally {
+          configureThreadPool({});
+        }
+      });
+
+      it('Queues async queries by priority', async () => {
+        const results = await Promise.all([
+          db.executeAsync('SELECT 1 as value', [], {priority: 'background'}),
+          db.executeAsync('SELECT 2 as value', [], {priority: 'interactive'}),
+          db.executeBatchAsync([['SELECT 3']], {priority: 'background'}),
+        ]);
+        expect(results[0].rows?._array[0].value).to.equal(1);
+        expect(results[1].rows?._array[0].value).to.equal(2);
+
+        expect(() =>
+          db.executeAsync('SELECT 1', [], {priority: 'urgent' as any}),
+        ).to.throw();
+      });
+
+      it('Stops queries past their timeout', async () => {
+        const endless =
+          'WITH RECURSIVE n(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM n) SELECT COUNT(*) FROM n';
+        // Running queries are only stopped on a connection of their own
+        const owned = open({
+          name: 'cancelTest.sqlite',
+          encryptionKey: 'test',
+          ownedConnection: true,
+        });
+
+        let error: any;
+        try {
+          await owned.executeAsync(endless, [], {timeoutMs: 50});
+        } catch (e) {
+          error = e;
+        }
+        expect(error?.message).to.contain('timed out');
+
+        owned.close();
+        owned.delete();
+      });
+
+      it('Cancels queries through an abort signal', async () => {
+        const endless =
+          'WITH RECURSIVE n(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM n) SELECT COUNT(*) FROM n';
+        const owned = open({
+          name: 'cancelTest.sqlite',
+          encryptionKey: 'test',
+          ownedConnection: true,
+        });
+        const controller = new AbortController();
+
+        const running = owned.executeAsync(endless, [], {
+          signal: controller.signal,
+        });
+        // Queued behind the running one, never started
+        const queued = owned.executeAsync('SELECT 1', [], {
+          signal: controller.signal,
+        });
+        setTimeout(() => controller.abort(), 20);
+
+        const results = await Promise.allSettled([running, queued]);
+        results.forEach(result => {
+          expect(result.status).to.equal('rejected');
+          expect((result as any).reason.message).to.contain('cancelled');
+        });
+
+        const res = await owned.executeAsync('SELECT 1 as value');
+        expect(res.rows?._array[0].value).to.equal(1);
+
+        owned.close();
+        owned.delete();
+      });
+
+      it('Rejects cancellation of sync queries on a shared connection', () => {
+        expect(() => db.execute('SELECT 1', [], {timeoutMs: 50})).to.throw(
+          /ownedConnection/,
+        );
+      });
+
+      it('Cursor returns rows in chunks', async () => {
+        for (let i = 0; i < 25; i++) {
+          db.execute('INSERT INTO User (id, name, age) VALUES(?, ?, ?)', [
+            i,
+            chance.name(),
+            i,
+          ]);
+        }
+
+        const cursor = db.openCursor('SELECT * FROM User WHERE age >= ?', [
+          5,
+        ]);
+
+        const first = await cursor.next(10);
+        expect(first.length).to.equal(10);
+        expect(first[0].id).to.equal(5);
+
+        const second = await cursor.next(10);
+        expect(second.length).to.equal(10);
+        expect(second[0].id).to.equal(15);
+
+        const last = await cursor.next(10);
+        expect(last).to.eql([]);
+        cursor.close();
+      });
+
+      it('Cursor supports async iteration', async () => {
+        for (let i = 0; i < 25; i++) {
+          db.execute('INSERT INTO User (id, name) VALUES(?, ?)', [
+            i,
+            chance.name(),
+          ]);
+        }
+
+        const ids: number[] = [];
+        for await (const row of db.openCursor(
+          'SELECT id FROM User',
+          [],
+          7,
+        )) {
+          ids.push(row.id);
+        }
+
+        expect(ids.length).to.equal(25);
+        expect(ids[24]).to.equal(24);
+      });
+
+      it('Cursor throws on a query without a statement', () => {
+        expect(() => db.openCursor('  -- nothing to read')).to.throw(
+          '[op-sqlite][openCursor]',
+        );
+      });
+    }
+
     it('Create fts5 virtual table', () => {
       db.execute('CREATE VIRTUAL TABLE fts5_table USING fts5(name, content);');
       db.execute('INSERT INTO fts5_table (name, content) VALUES(?, ?)', [
@@ -101,6 +101,33 @@ export type SQLBatchTuple = [string] | [string, Array<any> | Array<Array<any>>];
 
 export type UpdateHookOperation = 'INSERT' | 'DELETE' | 'UPDATE';
 
+/**
+ * transactionMode: how the transaction wrapping the batch is started,
+ * defaults to immediate
+ * chunkSize: commits every that many commands, so the journal of a big batch
+ * does not grow without bound. Chunks that were already committed stay if a
+ * later command fails. Ignored when the batch runs inside a transaction
+ * Both options are ignored by libsql
+ * priority: lane of the thread pool executeBatchAsync is queued on
+ */
+export type BatchOptions = {
+  transactionMode?: 'deferred' | 'immediate' | 'exclusive';
+  chunkSize?: number;
+  priority?: QueryPriority;
+};
+
+/**
+ * Lane of the thread pool an async call is queued on. Interactive work is
+ * taken first, background work (loadFile by default) runs on a share of the
+ * threads at a lower thread priority
+ */
+export type QueryPriority = 'interactive' | 'normal' | 'background';
+
+export type ColumnarValues = Record<
+  string,
+  Float64Array | Int32Array | (string | null)[]
+>;
+
 /**
  * status: 0 or undefined for correct execution, 1 for error
  * message: if status === 1, here you will find error description
@@ -118,16 +145,127 @@ export interface FileLoadResult extends BatchQueryResult {
   commands?: number;
 }
 
+/**
+ * rowMode 'object' returns the rows as plain objects instead of host objects.
+ * They take longer to create but every property read afterwards is a plain JS
+ * read, worth it when all the rows get read or passed around
+ */
+export type ExecuteOptions = {
+  rowMode?: 'hostObject' | 'object';
+  /**
+   * Rows are created the first time they are read instead of all up front,
+   * for large results of which only a few rows are looked at. rows._array is
+   * then a Proxy that behaves like a read-only array
+   */
+  lazyRows?: boolean;
+  /**
+   * Integers beyond Number.MAX_SAFE_INTEGER are returned as BigInt instead of
+   * a rounded number. BigInt params are always bound as 64 bit integers
+   */
+  bigInt?: boolean;
+  /**
+   * executeAsync only. Rows are converted on the JS thread in chunks taking
+   * at most this many milliseconds each, the event loop runs between chunks
+   * so a large result does not freeze the UI
+   */
+  chunkBudgetMs?: number;
+  /**
+   * executeAsync only. Receives the rows chunk by chunk (8ms chunks unless
+   * chunkBudgetMs says otherwise), the promise then resolves with a result
+   * without rows once the last chunk has been delivered
+   */
+  onChunk?: (rows: any[]) => void;
+  /**
+   * Cancels the query once aborted: a query still queued is not run, a
+   * running one is stopped between steps. The promise rejects either way.
+   * Stopping a running query needs the connection to itself, a reader
+   * connection or a database opened with ownedConnection, otherwise only a
+   * queued query is cancelled. execute only accepts it, like timeoutMs, with
+   * ownedConnection
+   */
+  signal?: {
+    aborted: boolean;
+    addEventListener: (
+      type: 'abort',
+      listener: () => void,
+      options?: any
+    ) => void;
+  };
+  /**
+   * Fails the query when it has not finished this many milliseconds after
+   * the call, time spent queued included
+   */
+  timeoutMs?: number;
+  /**
+   * executeAsync only, see QueryPriority
+   */
+  priority?: QueryPriority;
+  /**
+   * Serves a single SELECT from the result cache and stores its rows there,
+   * see setResultCache. Ignored while the cache is off
+   */
+  cache?: boolean;
+};
+
 export interface Transaction {
-  commit: () => QueryResult;
-  execute: (query: string, params?: any[]) => QueryResult;
+  /**
+   * Resolves once COMMIT has run, after the executeAsync calls sent before
+   * it. transaction() waits for it, there is no need to await it inside fn
+   */
+  commit: () => Promise<QueryResult>;
+  execute: (
+    query: string,
+    params?: any[],
+    options?: ExecuteOptions
+  ) => QueryResult;
   executeAsync: (
     query: string,
-    params?: any[] | undefined
+    params?: any[] | undefined,
+    options?: ExecuteOptions
   ) => Promise<QueryResult>;
-  rollback: () => QueryResult;
+  /** Same as commit, with ROLLBACK */
+  rollback: () => Promise<QueryResult>;
+  /**
+   * Runs fn inside a savepoint, its changes are rolled back if it throws
+   * while the rest of the transaction carries on. Savepoints can be nested
+   */
+  savepoint: (fn: (tx: Transaction) => Promise<void>) => Promise<void>;
 }
 
+/**
+ * Transaction open on the native side, it has the connection to itself until
+ * commit or rollback. Used by transaction()
+ *
+ * Until then the async work of the database sent while it is open,
+ * db.executeAsync, executeRawAsync, executeBatchAsync and cursor reads, runs
+ * inside it in order with its own statements. db.execute runs right away,
+ * inside the transaction too. Other transactions wait until it ends, awaiting
+ * db.transaction before committing never resolves. A transaction that is
+ * never committed or rolled back holds the database until it is garbage
+ * collected or the database is closed
+ *
+ * Savepoints, commit and rollback run in order after the async statements
+ * sent before them. execute throws while any of them is still running
+ */
+export type NativeTransaction = {
+  execute: (
+    query: string,
+    params?: any[],
+    options?: ExecuteOptions
+  ) => QueryResult;
+  executeAsync: (
+    query: string,
+    params?: any[],
+    options?: ExecuteOptions
+  ) => Promise<QueryResult>;
+  commit: () => Promise<QueryResult>;
+  rollback: () => Promise<QueryResult>;
+  savepoint: () => Promise<QueryResult>;
+  releaseSavepoint: () => Promise<QueryResult>;
+  rollbackSavepoint: () => Promise<QueryResult>;
+  finalized: boolean;
+};
+
 export interface PendingTransaction {
   /*
    * The start function should not throw or return a promise because the
@@ -141,11 +279,73 @@ export interface PendingTransaction {
   start: () => void;
 }
 
+/**
+ * Counters of the per-connection cache of prepared statements used by
+ * execute, executeAsync and executeRawAsync
+ */
+export type StatementCacheStats = {
+  hits: number;
+  misses: number;
+  evictions: number;
+  /** Number of statements currently cached */
+  size: number;
+  /** Memory used by the cached statements in bytes */
+  memory: number;
+};
+
+export type GroupCommitOptions = {
+  /** How long to wait for more writes before committing, defaults to 2ms */
+  windowMs?: number;
+  /** Commit as soon as this many writes are waiting, defaults to 100 */
+  maxWrites?: number;
+};
+
+export type ResultCacheOptions = {
+  /** Most results kept, least recently used ones are dropped first. Defaults to 100 */
+  maxEntries?: number;
+  /** Most memory used by the kept results in bytes, defaults to 4MB */
+  maxBytes?: number;
+  /**
+   * Results older than this are read again, needed when other processes
+   * write to the database. By default they are kept until a table they read
+   * changes
+   */
+  ttlMs?: number;
+};
+
+export type ResultCacheStats = {
+  hits: number;
+  misses: number;
+  /** hits / (hits + misses), 0 before the first lookup */
+  hitRatio: number;
+  /** Results dropped because a table they read changed */
+  invalidations: number;
+  /** Results dropped to stay under maxEntries or maxBytes */
+  evictions: number;
+  /** Number of results currently cached */
+  size: number;
+  /** Memory used by the cached results in bytes */
+  memory: number;
+};
+
 export type PreparedStatementObj = {
   bind: (params: any[]) => void;
   execute: () => QueryResult;
 };
 
+/**
+ * Reads the rows of a query in chunks instead of loading the whole result
+ * set in memory. The next chunk is read ahead in the background while the
+ * current one is processed. Can also be consumed with `for await`
+ */
+export type Cursor = {
+  /** Resolves with up to `rows` rows, an empty array means there are no more */
+  next: (rows: number) => Promise<any[]>;
+  /** Releases the statement, needed only if the cursor is not read until the end */
+  close: () => void;
+  [Symbol.asyncIterator]: () => AsyncIterator<any>;
+};
+
 export type DB = {
   close: () => void;
   delete: (location?: string) => void;
@@ -156,11 +356,50 @@ export type DB = {
     location?: string
   ) => void;
   detach: (mainDbName: string, alias: string) => void;
+  /**
+   * Runs fn inside a transaction, committed once it resolves and rolled back
+   * if it throws. Outside of libsql other transactions wait until it ends and
+   * the rest of the work of the database sent meanwhile runs inside it, see
+   * NativeTransaction
+   */
   transaction: (fn: (tx: Transaction) => Promise<void>) => Promise<void>;
-  execute: (query: string, params?: any[]) => QueryResult;
-  executeAsync: (query: string, params?: any[]) => Promise<QueryResult>;
-  executeBatch: (commands: SQLBatchTuple[]) => BatchQueryResult;
-  executeBatchAsync: (commands: SQLBatchTuple[]) => Promise<BatchQueryResult>;
+  beginTransaction: () => Promise<NativeTransaction>;
+  /**
+   * Inserts rows given column by column, every column must have the same
+   * length. Typed arrays are bound straight from their memory, without
+   * creating a JS value per row. The async version copies each typed array
+   * once. Not available in libsql
+   */
+  insertColumns: (table: string, columns: ColumnarValues) => BatchQueryResult;
+  insertColumnsAsync: (
+    table: string,
+    columns: ColumnarValues
+  ) => Promise<BatchQueryResult>;
+  /**
+   * Runs every statement of the query. The rows of all of them are returned
+   * together, so they must have the same columns: a statement returning
+   * other columns than the rows read before it fails the query, the
+   * statements before it keep their effects. Run such statements separately.
+   * The same goes for executeAsync
+   */
+  execute: (
+    query: string,
+    params?: any[],
+    options?: ExecuteOptions
+  ) => QueryResult;
+  executeAsync: (
+    query: string,
+    params?: any[],
+    options?: ExecuteOptions
+  ) => Promise<QueryResult>;
+  executeBatch: (
+    commands: SQLBatchTuple[],
+    options?: BatchOptions
+  ) => BatchQueryResult;
+  executeBatchAsync: (
+    commands: SQLBatchTuple[],
+    options?: BatchOptions
+  ) => Promise<BatchQueryResult>;
   loadFile: (location: string) => Promise<FileLoadResult>;
   updateHook: (
     callback?:
@@ -178,6 +417,37 @@ export type DB = {
   loadExtension: (path: string, entryPoint?: string) => void;
   executeRawAsync: (query: string, params?: any[]) => Promise<any[]>;
   getDbPath: (location?: string) => string;
+  getStatementCacheStats: () => StatementCacheStats;
+  openCursor: (query: string, params?: any[], chunkSize?: number) => Cursor;
+  /**
+   * Commits single INSERT, UPDATE, DELETE and REPLACE statements sent through
+   * executeAsync together in one transaction, each promise still resolves
+   * with its own result and a failing write does not affect the others.
+   * A write that ends the transaction itself, with ON CONFLICT ROLLBACK or
+   * RAISE(ROLLBACK), also fails the writes committed with it before.
+   * Pass null to turn it off
+   */
+  setGroupCommit: (options: GroupCommitOptions | null) => void;
+  /**
+   * Identical SELECT queries, same SQL and same params, sent through
+   * executeAsync while the first one is still queued or running get its rows
+   * instead of running again. Each promise still resolves with its own result
+   * built with its own options. Anything else sent to the database in between
+   * starts a new query, so a read never misses a write sent before it.
+   * Queries with a signal or a timeout are never shared. Writes made through
+   * prepared statements or transactions do not count, avoid sharing reads
+   * that race with them
+   */
+  setSingleFlight: (enabled: boolean) => void;
+  /**
+   * Keeps the rows of SELECT queries run with the cache option, later runs
+   * with the same SQL and params get them without touching the database. A
+   * result is dropped as soon as a table it read is written on this
+   * connection, committed or not. Pass null to turn it off and drop
+   * everything
+   */
+  setResultCache: (options: ResultCacheOptions | null) => void;
+  getResultCacheStats: () => ResultCacheStats;
   reactiveExecute: (params: {
     query: string;
     arguments: any[];
@@ -195,6 +465,8 @@ type OPSQLiteProxy = {
     name: string;
     location?: string;
     encryptionKey?: string;
+    readerConnections?: number;
+    ownedConnection?: boolean;
   }) => DB;
   openRemote: (options: { url: string; authToken: string }) => DB;
   openSync: (options: {
@@ -205,6 +477,7 @@ type OPSQLiteProxy = {
   }) => DB;
   isSQLCipher: () => boolean;
   isLibsql: () => boolean;
+  configureThreadPool: (options: ThreadPoolOptions) => void;
 };
 
 const locks: Record<
@@ -212,9 +485,42 @@ const locks: Record<
   { queue: PendingTransaction[]; inProgress: boolean }
 > = {};
 
+// Array view of the native lazy rows, a row is only created when its index
+// is read
+function createLazyRowArray(lazyRows: any, length: number): any[] {
+  const rowIndex = (prop: string | symbol): number => {
+    if (typeof prop !== 'string') {
+      return -1;
+    }
+    const index = Number(prop);
+    return Number.isInteger(index) &&
+      index >= 0 &&
+      index < length &&
+      String(index) === prop
+      ? index
+      : -1;
+  };
+
+  return new Proxy(new Array(length), {
+    get: (target, prop, receiver) => {
+      const index = rowIndex(prop);
+      return index === -1
+        ? Reflect.get(target, prop, receiver)
+        : lazyRows[index];
+    },
+    has: (target, prop) => rowIndex(prop) !== -1 || Reflect.has(target, prop),
+  });
+}
+
 // Enhance some host functions
 // Add 'item' function to result object to allow the sqlite-storage typeorm driver to work
 function enhanceQueryResult(result: QueryResult): void {
+  const rows = result.rows as any;
+  if (rows?._lazyRows != null) {
+    rows._array = createLazyRowArray(rows._lazyRows, rows.length);
+    delete rows._lazyRows;
+  }
+
   // Add 'item' function to result object to allow the sqlite-storage typeorm driver to work
   if (result.rows == null) {
     result.rows = {
@@ -228,6 +534,104 @@ function enhanceQueryResult(result: QueryResult): void {
   }
 }
 
+// Typed arrays are passed to the native side as their underlying buffer
+function sanitizeParams(params?: any[]): any[] | undefined {
+  return params?.map((p) => {
+    if (ArrayBuffer.isView(p)) {
+      return p.buffer;
+    }
+
+    return p;
+  });
+}
+
+// The native transaction holds the connection until it is committed or
+// rolled back, so unlike the libsql one it does not need a JS queue
+async function runNativeTransaction(
+  db: DB,
+  fn: (tx: Transaction) => Promise<void>
+): Promise<void> {
+  const nativeTx = await db.beginTransaction();
+  // Commit or rollback sent by fn, waited for before returning
+  let finalizing: Promise<QueryResult> | undefined;
+
+  const tx: Transaction = {
+    execute: (
+      query: string,
+      params?: any[],
+      executeOptions?: ExecuteOptions
+    ): QueryResult => {
+      const result = nativeTx.execute(
+        query,
+        sanitizeParams(params),
+        executeOptions
+      );
+      enhanceQueryResult(result);
+      return result;
+    },
+    executeAsync: async (
+      query: string,
+      params?: any[] | undefined,
+      executeOptions?: ExecuteOptions
+    ): Promise<QueryResult> => {
+      const result = await nativeTx.executeAsync(
+        query,
+        sanitizeParams(params),
+        executeOptions
+      );
+      enhanceQueryResult(result);
+      return result;
+    },
+    commit: () => {
+      finalizing = nativeTx.commit().then((result) => {
+        enhanceQueryResult(result);
+        return result;
+      });
+      return finalizing;
+    },
+    rollback: () => {
+      finalizing = nativeTx.rollback().then((result) => {
+        enhanceQueryResult(result);
+        return result;
+      });
+      return finalizing;
+    },
+    savepoint: async (savepointFn: (tx: Transaction) => Promise<void>) => {
+      await nativeTx.savepoint();
+
+      try {
+        await savepointFn(tx);
+      } catch (savepointError) {
+        if (!nativeTx.finalized) {
+          await nativeTx.rollbackSavepoint();
+        }
+        throw savepointError;
+      }
+
+      if (!nativeTx.finalized) {
+        await nativeTx.releaseSavepoint();
+      }
+    },
+  };
+
+  try {
+    await fn(tx);
+
+    if (!nativeTx.finalized) {
+      await tx.commit();
+    } else {
+      await finalizing;
+    }
+  } catch (executionError) {
+    console.warn('transaction error', executionError);
+    if (!nativeTx.finalized) {
+      await tx.rollback();
+    }
+
+    throw executionError;
+  }
+}
+
 function enhanceDB(db: DB, options: any): DB {
   const lock = {
     queue: [] as PendingTransaction[],
@@ -269,13 +673,25 @@ function enhanceDB(db: DB, options: any): DB {
     loadExtension: db.loadExtension,
     executeRawAsync: db.executeRawAsync,
     getDbPath: db.getDbPath,
+    getStatementCacheStats: db.getStatementCacheStats,
+    setGroupCommit: db.setGroupCommit,
+    setSingleFlight: db.setSingleFlight,
+    setResultCache: db.setResultCache,
+    getResultCacheStats: db.getResultCacheStats,
+    beginTransaction: db.beginTransaction,
+    insertColumns: db.insertColumns,
+    insertColumnsAsync: db.insertColumnsAsync,
     reactiveExecute: db.reactiveExecute,
     sync: db.sync,
     close: () => {
       db.close();
       delete locks[options.url];
     },
-    execute: (query: string, params?: any[] | undefined): QueryResult => {
+    execute: (
+      query: string,
+      params?: any[] | undefined,
+      executeOptions?: ExecuteOptions
+    ): QueryResult => {
       const sanitizedParams = params?.map((p) => {
         if (ArrayBuffer.isView(p)) {
           return p.buffer;
@@ -284,13 +700,14 @@ function enhanceDB(db: DB, options: any): DB {
         return p;
       });
 
-      const result = db.execute(query, sanitizedParams);
+      const result = db.execute(query, sanitizedParams, executeOptions);
       enhanceQueryResult(result);
       return result;
     },
     executeAsync: async (
       query: string,
-      params?: any[] | undefined
+      params?: any[] | undefined,
+      executeOptions?: ExecuteOptions
     ): Promise<QueryResult> => {
       const sanitizedParams = params?.map((p) => {
         if (ArrayBuffer.isView(p)) {
@@ -300,10 +717,47 @@ function enhanceDB(db: DB, options: any): DB {
         return p;
       });
 
-      const result = await db.executeAsync(query, sanitizedParams);
+      const result = await db.executeAsync(
+        query,
+        sanitizedParams,
+        executeOptions
+      );
       enhanceQueryResult(result);
       return result;
     },
+    openCursor: (
+      query: string,
+      params?: any[] | undefined,
+      chunkSize = 100
+    ): Cursor => {
+      const sanitizedParams = params?.map((p) => {
+        if (ArrayBuffer.isView(p)) {
+          return p.buffer;
+        }
+
+        return p;
+      });
+
+      const cursor = db.openCursor(query, sanitizedParams);
+
+      return {
+        next: (rows: number) => cursor.next(rows),
+        close: () => cursor.close(),
+        [Symbol.asyncIterator]: async function* () {
+          try {
+            while (true) {
+              const rows = await cursor.next(chunkSize);
+              if (rows.length === 0) {
+                return;
+              }
+              yield* rows;
+            }
+          } finally {
+            cursor.close();
+          }
+        },
+      };
+    },
     prepareStatement: (query: string) => {
       const stmt = db.prepareStatement(query);
 
@@ -329,28 +783,41 @@ function enhanceDB(db: DB, options: any): DB {
     transaction: async (
       fn: (tx: Transaction) => Promise<void>
     ): Promise<void> => {
+      if (!isLibsql()) {
+        return runNativeTransaction(db, fn);
+      }
+
       let isFinalized = false;
+      let savepoints = 0;
 
       // Local transaction context object implementation
-      const execute = (query: string, params?: any[]): QueryResult => {
+      const execute = (
+        query: string,
+        params?: any[],
+        executeOptions?: ExecuteOptions
+      ): QueryResult => {
         if (isFinalized) {
           throw Error(
             `OP-Sqlite Error: Database: ${options.url}. Cannot execute query on finalized transaction`
           );
         }
-        return enhancedDb.execute(query, params);
+        return enhancedDb.execute(query, params, executeOptions);
       };
 
-      const executeAsync = (query: string, params?: any[] | undefined) => {
+      const executeAsync = (
+        query: string,
+        params?: any[] | undefined,
+        executeOptions?: ExecuteOptions
+      ) => {
         if (isFinalized) {
           throw Error(
             `OP-Sqlite Error: Database: ${options.url}. Cannot execute query on finalized transaction`
           );
         }
-        return enhancedDb.executeAsync(query, params);
+        return enhancedDb.executeAsync(query, params, executeOptions);
       };
 
-      const commit = () => {
+      const commit = async () => {
         if (isFinalized) {
           throw Error(
             `OP-Sqlite Error: Database: ${options.url}. Cannot execute query on finalized transaction`
@@ -361,7 +828,7 @@ function enhanceDB(db: DB, options: any): DB {
         return result;
       };
 
-      const rollback = () => {
+      const rollback = async () => {
         if (isFinalized) {
           throw Error(
             `OP-Sqlite Error: Database: ${options.url}. Cannot execute query on finalized transaction`
@@ -372,25 +839,52 @@ function enhanceDB(db: DB, options: any): DB {
         return result;
       };
 
+      const savepoint = async (
+        savepointFn: (tx: Transaction) => Promise<void>
+      ) => {
+        savepoints++;
+        const name = `opsqlite_savepoint_${savepoints}`;
+        execute(`SAVEPOINT ${name};`);
+
+        try {
+          await savepointFn(tx);
+        } catch (savepointError) {
+          if (!isFinalized) {
+            execute(`ROLLBACK TO ${name};`);
+            execute(`RELEASE ${name};`);
+          }
+          throw savepointError;
+        } finally {
+          savepoints--;
+        }
+
+        if (!isFinalized) {
+          execute(`RELEASE ${name};`);
+        }
+      };
+
+      const tx: Transaction = {
+        commit,
+        execute,
+        executeAsync,
+        rollback,
+        savepoint,
+      };
+
       async function run() {
         try {
           await enhancedDb.executeAsync('BEGIN TRANSACTION;');
 
-          await fn({
-            commit,
-            execute,
-            executeAsync,
-            rollback,
-          });
+          await fn(tx);
 
           if (!isFinalized) {
-            commit();
+            await commit();
           }
         } catch (executionError) {
           console.warn('transaction error', executionError);
           if (!isFinalized) {
             try {
-              rollback();
+              await rollback();
             } catch (rollbackError) {
               throw rollbackError;
             }
@@ -448,10 +942,28 @@ export const openRemote = (options: { url: string; authToken: string }): DB => {
   return enhancedDb;
 };
 
+/**
+ * readerConnections: opens that many extra read-only connections and switches
+ * the database to WAL mode. SELECT queries sent through executeAsync and
+ * executeRawAsync then run on them in parallel with the queries sent after
+ * them. A read sent while other work of the database is still queued or
+ * running, or while a transaction is open, waits in the queue like any other
+ * query so it sees their changes. Not available for in-memory databases
+ * ownedConnection: the connection is opened without SQLite's own locking,
+ * which it otherwise takes on every call while a query steps. Instead each
+ * native call, sync or async, has the connection to itself for as long as
+ * it runs, so a sync execute waits for the async query running at that
+ * moment. Ownership lasts one call: a sync execute can still run between the
+ * statements of a group commit or of a native transaction. It does not make
+ * builds without SQLite's mutexes (performanceMode 1) safe to use from
+ * several threads, those cannot open readerConnections. Ignored by libsql
+ */
 export const open = (options: {
   name: string;
   location?: string;
   encryptionKey?: string;
+  readerConnections?: number;
+  ownedConnection?: boolean;
 }): DB => {
   const db = OPSQLite.open(options);
   const enhancedDb = enhanceDB(db, options);
@@ -467,6 +979,30 @@ export const moveAssetsDatabase = async (args: {
   return NativeModules.OPSQLite.moveAssetsDatabase(args);
 };
 
+/**
+ * maxThreads: most threads the async functions run on, one per core by
+ * default
+ * elastic: threads are started one at a time, when queued work has waited
+ * more than growAfterMs (5 by default), and stopped after idleTimeoutMs
+ * (10000 by default) without work. Otherwise they are all started with the
+ * first async call and kept
+ */
+export type ThreadPoolOptions = {
+  maxThreads?: number;
+  elastic?: boolean;
+  growAfterMs?: number;
+  idleTimeoutMs?: number;
+};
+
+/**
+ * Sizes the thread pool, best called once before the first async call. No
+ * thread is started until then. Threads that are running finish their
+ * current task and are replaced
+ */
+export const configureThreadPool = (options: ThreadPoolOptions): void => {
+  OPSQLite.configureThreadPool(options);
+};
+
 export const isSQLCipher = (): boolean => {
   return OPSQLite.isSQLCipher();
 };